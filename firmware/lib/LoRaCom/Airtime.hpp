@@ -0,0 +1,79 @@
+// Airtime.hpp
+#ifndef Airtime_h
+#define Airtime_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Time on air of one LoRa packet in microseconds, SX126x datasheet formula.
+// cr is the RadioLib coding rate denominator (5..8 for 4/5..4/8), bwHz the
+// bandwidth in Hz. Low data rate optimisation is switched on the same way
+// RadioLib does it automatically: symbol time of 16 ms or more.
+constexpr uint32_t loraTimeOnAirUs(uint8_t sf, uint32_t bwHz, uint8_t cr, uint16_t preamble,
+                                   size_t payloadLen, bool crc = true, bool explicitHeader = true) {
+  const bool ldro = ((uint64_t)1000 << sf) >= (uint64_t)16 * bwHz;
+  const int32_t bitsPerSymbol = 4 * (ldro ? sf - 2 : sf);
+
+  int32_t payloadBits = 8 * (int32_t)payloadLen + (crc ? 16 : 0) - 4 * sf + (explicitHeader ? 20 : 0);
+  if (sf >= 7) payloadBits += 8;
+  if (payloadBits < 0) payloadBits = 0;
+  const int32_t payloadSymbols = 8 + ((payloadBits + bitsPerSymbol - 1) / bitsPerSymbol) * cr;
+
+  // Symbol count times four keeps the 4.25 / 6.25 preamble tail integral
+  const uint64_t symbolsX4 = 4 * (uint64_t)preamble + (sf < 7 ? 25 : 17) + 4 * (uint64_t)payloadSymbols;
+  return (uint32_t)((symbolsX4 * ((uint64_t)1000000 << sf)) / (4 * (uint64_t)bwHz));
+}
+
+// Checked against the Semtech LoRa calculator
+static_assert(loraTimeOnAirUs(7, 125000, 5, 8, 10) == 41216, "SF7/125k, 10 bytes");
+static_assert(loraTimeOnAirUs(11, 250000, 5, 20, 2) == 305152, "SF11/250k status packet");
+static_assert(loraTimeOnAirUs(12, 125000, 5, 8, 20) == 1318912, "SF12/125k uses LDRO");
+
+#define AIRTIME_WINDOW_BUCKETS 60
+
+// Airtime used in a sliding window, kept in AIRTIME_WINDOW_BUCKETS buckets so
+// memory stays fixed however many packets are sent. Not thread safe, the
+// owner serialises access.
+class AirtimeWindow {
+ public:
+  explicit AirtimeWindow(uint32_t windowMs) : m_windowMs(windowMs), m_bucketMs(windowMs / AIRTIME_WINDOW_BUCKETS) {}
+
+  void add(uint32_t airtimeUs, uint32_t nowMs) {
+    advance(nowMs);
+    m_buckets[m_bucket % AIRTIME_WINDOW_BUCKETS] += airtimeUs;
+    m_usedUs += airtimeUs;
+  }
+
+  uint64_t usedUs(uint32_t nowMs) {
+    advance(nowMs);
+    return m_usedUs;
+  }
+
+  uint32_t windowMs() const { return m_windowMs; }
+
+ private:
+  uint32_t m_windowMs;
+  uint32_t m_bucketMs;
+  uint32_t m_buckets[AIRTIME_WINDOW_BUCKETS] = {0};
+  uint32_t m_bucket = 0;  // Absolute index of the current bucket
+  uint64_t m_usedUs = 0;
+
+  // Drops buckets that slid out of the window
+  void advance(uint32_t nowMs) {
+    uint32_t bucket = nowMs / m_bucketMs;
+    if (bucket - m_bucket >= AIRTIME_WINDOW_BUCKETS) {
+      for (size_t i = 0; i < AIRTIME_WINDOW_BUCKETS; i++) m_buckets[i] = 0;
+      m_usedUs = 0;
+      m_bucket = bucket;
+      return;
+    }
+    while (m_bucket != bucket) {
+      m_bucket++;
+      uint32_t &expired = m_buckets[m_bucket % AIRTIME_WINDOW_BUCKETS];
+      m_usedUs -= expired;
+      expired = 0;
+    }
+  }
+};
+
+#endif
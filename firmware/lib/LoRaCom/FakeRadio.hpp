@@ -0,0 +1,49 @@
+// FakeRadio.hpp
+#ifndef FakeRadio_h
+#define FakeRadio_h
+
+#include <Arduino.h>
+#include <RadioLib.h>
+
+// Radio policy without hardware, always available as the fallback. Every
+// call succeeds at once, received packets come from LoRaComT's simulated
+// path (the periodic fake message or a replayed trace).
+class FakeRadio {
+ public:
+  static constexpr bool SIMULATED = true;
+
+  int begin(uint8_t CLK, uint8_t MISO, uint8_t MOSI, uint8_t csPin, uint8_t intPin, uint8_t RST,
+            float freqMHz, int8_t power, int8_t BUSY) { return RADIOLIB_ERR_NONE; }
+  void setIrqAction(void (*func)(void)) {}
+
+  int startReceive(bool latchPreamble) { return RADIOLIB_ERR_NONE; }
+  int startReceiveDutyCycle() { return RADIOLIB_ERR_NONE; }
+  bool packetInFlight() { return false; }
+  size_t packetLength() { return 0; }
+  int readData(uint8_t *buffer, size_t len) { return RADIOLIB_ERR_NONE; }
+  float packetRssi() { return -40; }
+  float packetSnr() { return 0; }
+  float frequencyError() { return 0; }
+  float channelRssi() { return -120; }  // Instantaneous reading for the noise sampler
+
+  int startTransmit(const uint8_t *data, size_t len) { return RADIOLIB_ERR_NONE; }
+  int finishTransmit() { return RADIOLIB_ERR_NONE; }
+  int standby() { return RADIOLIB_ERR_NONE; }
+
+  int setOutputPower(int8_t power) { return RADIOLIB_ERR_NONE; }
+  int setFrequency(float freq) { return RADIOLIB_ERR_NONE; }
+  int setSpreadingFactor(uint8_t sf) { return RADIOLIB_ERR_NONE; }
+  int setBandwidth(float bw) { return RADIOLIB_ERR_NONE; }
+  int setCodingRate(uint8_t cr) { return RADIOLIB_ERR_NONE; }
+  int setSyncWord(uint8_t syncWord) { return RADIOLIB_ERR_NONE; }
+
+  // CAD result, busyScans lets fake mode exercise the LBT backoff
+  uint8_t busyScans = 0;
+  bool channelBusy() {
+    if (busyScans == 0) return false;
+    busyScans--;
+    return true;
+  }
+};
+
+#endif
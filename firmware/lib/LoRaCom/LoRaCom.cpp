@@ -1,281 +1,376 @@
 // LoRaCom.cpp
 #include "LoRaCom.hpp"
 #include "../lora_config.hpp"
-#include "../wifi_manager/wifi_manager.hpp"
-
-// Meshtastic-style duty cycle parameters
-#define MESHTASTIC_PREAMBLE_LENGTH 20 // было 8 - не правильно. 
-#define MESHTASTIC_RADIOLIB_IRQ_RX_FLAGS RADIOLIB_IRQ_RX_DONE | RADIOLIB_IRQ_PREAMBLE_DETECTED | RADIOLIB_IRQ_HEADER_VALID
-
-extern void* wifi_manager_global;
-extern volatile bool force_lora_trigger;
 
 LoRaCom *LoRaCom::instance = nullptr;
 
 LoRaCom::LoRaCom() {
   instance = this;  // Set the static instance pointer
+  radioMutex = xSemaphoreCreateMutex();
+  txQueue = xQueueCreate(LORA_TX_QUEUE_SIZE, sizeof(TxFrame));
   ESP_LOGI(TAG, "LoRaCom constructor called");
 }
 
+LoRaCom::~LoRaCom() {
+  stopRadioTask();
+  if (instance == this) instance = nullptr;
+  vQueueDelete(txQueue);
+  vSemaphoreDelete(radioMutex);
+}
+
 // void LoRaCom::setRxFlag() {
 //   if (instance) {
 //     instance->RxFlag = true;
 //   }
 // }
 
-void LoRaCom::RxTxCallback(void) {
-  if (instance) {
+void IRAM_ATTR LoRaCom::RxTxCallback(void) {
+  if (instance && !instance->cadActive) {
     if (instance->TxMode) {
       // Just set flag, actual processing in task
+      instance->txDoneIrqUs = esp_timer_get_time();
       instance->TxFinished = true;
-      return;
+    } else {
+      instance->rxIrqTimeUs = esp_timer_get_time();
+      instance->RxFlag = true;
     }
-    instance->RxFlag = true;
+
+    // Wake the radio task straight away instead of waiting for its next poll
+    if (instance->radioTaskHandle) {
+      BaseType_t higherPriorityTaskWoken = pdFALSE;
+      vTaskNotifyGiveFromISR(instance->radioTaskHandle, &higherPriorityTaskWoken);
+      portYIELD_FROM_ISR(higherPriorityTaskWoken);
+    }
+  }
+}
+
+void LoRaCom::updateRxLatency(int64_t irqTimeUs) {
+  uint32_t latencyUs = (uint32_t)(esp_timer_get_time() - irqTimeUs);
+  rxLatency.lastUs = latencyUs;
+  if (rxLatency.count == 0 || latencyUs < rxLatency.minUs) rxLatency.minUs = latencyUs;
+  if (latencyUs > rxLatency.maxUs) rxLatency.maxUs = latencyUs;
+  rxLatency.totalUs += latencyUs;
+  rxLatency.count++;
+}
+
+bool LoRaCom::send(const uint8_t *data, size_t length, TxDoneCallback onDone, void *context) {
+  if (length == 0 || length > LORA_MAX_PACKET_LEN) {
+    ESP_LOGE(TAG, "Cannot send %u bytes, allowed 1..%d", (unsigned)length, LORA_MAX_PACKET_LEN);
+    return false;
+  }
+  if (!radioInitialised) {
+    ESP_LOGW(TAG, "Cannot send: radio not initialised");
+    return false;
   }
+
+  TxFrame frame;
+  memcpy(frame.data, data, length);
+  frame.length = length;
+  frame.onDone = onDone;
+  frame.context = context;
+  // Never block the caller, a full queue means the air is already saturated
+  if (xQueueSend(txQueue, &frame, 0) != pdTRUE) {
+    txDropped++;
+    ESP_LOGW(TAG, "TX queue full (%d frames), frame dropped", LORA_TX_QUEUE_SIZE);
+    return false;
+  }
+  if (radioTaskHandle) {
+    xTaskNotifyGive(radioTaskHandle);
+  }
+  return true;
 }
 
 void LoRaCom::sendMessage(const char *msg) {
-  if (isFakeMode) {
-    if (msg[0] != '\0') {
-      ESP_LOGI(TAG, "Fake transmitting: <%s>", msg);
-    }
-  } else {
-    if (radioInitialised && !TxMode) {
-      // Clear any pending RxFlag to allow transmission
-      RxFlag = false;
-      if (msg[0] != '\0') {
-        size_t msgLen = strlen(msg);
-        if (msgLen > 64) {  // Limit message length to prevent issues
-          ESP_LOGE(TAG, "Message too long: %d bytes, max 64", msgLen);
-          return;
-        }
-        int state = radioUnion.sRadio->startTransmit(msg);
-        instance->TxMode = true;
-        instance->txStartTime = millis();  // Record transmission start time
-        if (state == RADIOLIB_ERR_NONE) {
-          ESP_LOGD(TAG, "Transmitting: <%s>", msg);
-        } else {
-          ESP_LOGE(TAG, "Failed to begin transmission, code: %d", state);
-          instance->TxMode = false;  // Reset flag on failure
-        }
-      }
-    } else {
-      ESP_LOGW(TAG, "Cannot send: radioInitialised=%d, TxMode=%d",
-               radioInitialised, TxMode);
-    }
+  if (msg[0] != '\0') {
+    send(reinterpret_cast<const uint8_t *>(msg), strlen(msg));
   }
 }
 
-bool LoRaCom::checkTxMode() {
-  return TxMode;  // Return the current transmission mode status
+/* ================================ RADIO TASK ================================ */
+
+void LoRaCom::radioTaskWrapper(void *param) {
+  static_cast<LoRaCom *>(param)->radioTask();
+}
+
+void LoRaCom::startRadioTask() {
+  if (radioTaskHandle == nullptr) {
+    // Above the packet processing tasks so the FIFO is drained before it is overwritten
+    xTaskCreate(radioTaskWrapper, "LoRaRadioTask", 4096, this, 3, &radioTaskHandle);
+  }
 }
 
-bool LoRaCom::getMessage(char *buffer, size_t len, int* receivedLen) {
-  int actualLen = 0;
-  if (isFakeMode) {
-    // Simulate receiving a message occasionally
-    static int counter = 0;
-    counter++;
-    if (counter % 1000 == 0) {  // Every 1000th call - reduce spam
-      const char *fakeMsg = "Fake received message";
-      if (strlen(fakeMsg) < len) {
-        strcpy((char*)buffer, fakeMsg);
-        actualLen = strlen(fakeMsg);
-        if (receivedLen) *receivedLen = actualLen;
-        return true;
-      }
+void LoRaCom::stopRadioTask() {
+  if (radioTaskHandle != nullptr) {
+    TaskHandle_t handle = radioTaskHandle;
+    radioTaskHandle = nullptr;
+    vTaskDelete(handle);
+  }
+}
+
+uint32_t LoRaCom::radioWaitMs() {
+  uint32_t waitMs = LORA_RX_WAIT_TIMEOUT_MS;
+  // Wake up at the end of an LBT backoff instead of after the full timeout
+  if (getTxQueued() > 0) {
+    int32_t holdMs = (int32_t)(txHoldUntilMs - millis());
+    if (holdMs > 0 && (uint32_t)holdMs < waitMs) waitMs = holdMs;
+  }
+  // ... and at the end of the current hop dwell
+  if (hopActive) {
+    int32_t dwellMs = (int32_t)(hopDeadlineMs - millis());
+    if (dwellMs < 1) dwellMs = 1;
+    if ((uint32_t)dwellMs < waitMs) waitMs = dwellMs;
+  }
+  // ... and for the next replayed packet
+  if (replay.isActive()) {
+    uint32_t dueMs = (uint32_t)((replay.untilDueUs(esp_timer_get_time()) + 999) / 1000);
+    if (dueMs < 1) dueMs = 1;
+    if (dueMs < waitMs) waitMs = dueMs;
+  }
+  // ... and for the next noise sample
+  if (noiseEnabled) {
+    int32_t sampleMs = (int32_t)(noiseNextMs - millis());
+    if (sampleMs < 1) sampleMs = 1;
+    if ((uint32_t)sampleMs < waitMs) waitMs = sampleMs;
+  }
+  return waitMs;
+}
+
+bool LoRaCom::txBudgetAllows(size_t length) {
+  uint32_t toaUs = getTimeOnAirUs(length);
+#if TX_DUTY_CYCLE_LIMIT_ENABLED
+  uint64_t budgetUs = (uint64_t)TX_DUTY_CYCLE_WINDOW_MS * TX_DUTY_CYCLE_PERMILLE;
+  uint64_t usedUs = txAirtime.usedUs(millis());
+  if (usedUs + toaUs > budgetUs) {
+    if (!txWaitingForBudget) {
+      txWaitingForBudget = true;
+      txDeferred++;
+      ESP_LOGW(TAG, "Duty cycle budget used (%llu of %llu ms), %u byte frame (%lu ms) deferred",
+               (unsigned long long)(usedUs / 1000), (unsigned long long)(budgetUs / 1000), (unsigned)length,
+               (unsigned long)(toaUs / 1000));
     }
     return false;
-  } else {
-    // Check if transmission finished
-    if (TxFinished && radioInitialised) {
-      TxFinished = false;
-      unsigned long txDuration = millis() - txStartTime;  // Calculate transmission duration
-      int state = radioUnion.sRadio->finishTransmit();
-#if DUTY_CYCLE_RECEPTION == 1
-      // Use Meshtastic-style duty cycle reception for power efficiency
-      ESP_LOGD(TAG, "Using duty cycle reception after TX");
-      state |= radioUnion.sRadio->startReceiveDutyCycleAuto(MESHTASTIC_PREAMBLE_LENGTH, 8, MESHTASTIC_RADIOLIB_IRQ_RX_FLAGS);
-#else
-      // Use continuous receive for traffic testing
-      ESP_LOGD(TAG, "Using continuous reception after TX");
-      state |= radioUnion.sRadio->startReceive();
+  }
+  txWaitingForBudget = false;
 #endif
-      TxMode = false;
-      if (state == RADIOLIB_ERR_NONE) {
-        ESP_LOGI(TAG, "Tx done: %lu ms SF%d BW%.0f", txDuration, currentSF, currentBW);
-      } else {
-        ESP_LOGE(TAG, "Transmission failed, code: %d", state);
-      }
-    }
+  return true;
+}
 
-    if (RxFlag && radioInitialised) {
-      int state;  // Объявляем переменную state в начале блока
-
-#if PARSE_SENDER_ID_FROM_LORA_PACKETS == 1
-      // NEW METHOD: Parse sender_id from packet header when enabled
-      size_t packetLength = radioUnion.sRadio->getPacketLength();
-      if (packetLength > 7) {
-        // Read the entire packet including header
-        uint8_t tempBuffer[packetLength];
-        state = radioUnion.sRadio->readData(tempBuffer, packetLength);
-
-        // Extract destination_id and sender_id from header (Meshtastic format)
-        // Header format: to(4), from(4), id(4), channel/flags(1+) ...
-        if (packetLength >= 8) {
-          uint32_t destinationId = (tempBuffer[3] << 24) | (tempBuffer[2] << 16) | (tempBuffer[1] << 8) | tempBuffer[0];          
-          ((WiFiManager*)wifi_manager_global)->setLastDestinationId(destinationId);
-
-          uint32_t lastSenderId = (tempBuffer[7] << 24) | (tempBuffer[6] << 16) | (tempBuffer[5] << 8) | tempBuffer[4];
-          ((WiFiManager*)wifi_manager_global)->setLastSenderId(lastSenderId);
-          
-          ESP_LOGI(TAG, "Parsed destination_id: %u, sender_id: %u from packet length %d", destinationId, lastSenderId, packetLength);
-        }
-
-        // Copy payload to user's buffer (skip header if needed)
-        //size_t payloadLen = packetLength - 8;  // Assume 8-byte header
-        size_t payloadLen = packetLength;  // Assume 8-byte header
-        if (payloadLen > len) payloadLen = len;
-        memcpy((uint8_t*)buffer, tempBuffer + 8, payloadLen);
-        actualLen = payloadLen;
-      } else {
-        // Short packet - use sender_id = 1
-        lastSenderId = 1;
-        state = radioUnion.sRadio->readData(reinterpret_cast<uint8_t *>(buffer), len);
-        // Use same length detection logic as before
-        actualLen = 0;
-        for (size_t i = 0; i < len; i++) {
-          if (buffer[i] == '\0') {
-            actualLen = i;
-            break;
-          }
-        }
-        if (actualLen == 0) actualLen = len;
-        ESP_LOGI(TAG, "Short packet received, using sender_id = 1");
-      }
-#else
-      // OLD METHOD: Original logic when parsing is disabled - no getPacketLength() call
-      state = radioUnion.sRadio->readData(reinterpret_cast<uint8_t *>(buffer), len);
-#endif
+void LoRaCom::chargeTxBudget(size_t length) {
+  // Charged when the frame is started, so a frame is never counted twice
+  uint32_t toaUs = getTimeOnAirUs(length);
+  txAirtime.add(toaUs, millis());
+  lastTxToaUs = toaUs;
+}
 
-      RxFlag = false;
-      state |= radioUnion.sRadio->startReceive();
-      bool result = (state == RADIOLIB_ERR_NONE);
-
-      if (result) {
-        // Determine actual packet length
-#if PARSE_SENDER_ID_FROM_LORA_PACKETS == 0
-        // Original length detection when parsing disabled
-        actualLen = 0;
-        for (size_t i = 0; i < len; i++) {
-          if (buffer[i] == '\0') {
-            actualLen = i;
-            break;
-          }
-        }
-        if (actualLen == 0) {  // No null terminator found, assume we got data
-          // This is tricky - RadioLib doesn't return actual received length
-          // We'll use a heuristic or assume received something meaningful
-          actualLen = len;  // Default assumption
-        }
-#endif
+AirtimeStats LoRaCom::getAirtimeStats() {
+  AirtimeStats stats;
+  lockRadio();
+  uint32_t now = millis();
+  stats.txUs = txAirtime.usedUs(now);
+  stats.rxUs = rxAirtime.usedUs(now);
+  stats.windowMs = txAirtime.windowMs();
+  stats.budgetUs = (uint64_t)TX_DUTY_CYCLE_WINDOW_MS * TX_DUTY_CYCLE_PERMILLE;
+  stats.lastTxToaUs = lastTxToaUs;
+  stats.lastTxAirUs = lastTxAirUs;
+  stats.deferred = txDeferred;
+  unlockRadio();
+  return stats;
+}
 
-        if (receivedLen) *receivedLen = actualLen;
-      }
-      if (result && (POST_EN_WHEN_LORA_RECEIVED || force_lora_trigger) && wifi_manager_global) {
-        ESP_LOGI(TAG, "LoRa packet received, sending POST trigger");
-        ((WiFiManager*)wifi_manager_global)->setLoRaRssi(abs(radioUnion.sRadio->getRSSI()));
-        ((WiFiManager*)wifi_manager_global)->setLastFullPacketLen(packetLength);  // Set full packet length for Flask server
-        ((WiFiManager*)wifi_manager_global)->setSendPostOnLoRa(true);
-      }
-      return result;
-    }
-    return false;
+void LoRaCom::commitRxPacket(const RxMetadata &meta, size_t headerOffset) {
+  rxRing.commit(meta, headerOffset);
+  if (rxNotifyTask) {
+    xTaskNotifyGive(rxNotifyTask);
   }
 }
 
-int32_t LoRaCom::getRssi() {
-  if (isFakeMode) {
-    return -40;  // Fake RSSI
-  } else {
-    return radioUnion.sRadio->getRSSI();  // Return the last received signal strength
+/* ================================ TRACE REPLAY ============================== */
+
+bool LoRaCom::startReplay(const char *path, float speed, bool loop) {
+  if (!isSimulated()) {
+    ESP_LOGW(TAG, "Trace replay needs fake mode");
+    return false;
   }
+  lockRadio();
+  bool ok = replay.open(path, speed, loop, esp_timer_get_time());
+  unlockRadio();
+  if (ok && radioTaskHandle) xTaskNotifyGive(radioTaskHandle);
+  return ok;
 }
 
-/* ================================ SETTERS ================================ */
+void LoRaCom::stopReplay() {
+  lockRadio();
+  replay.close();
+  unlockRadio();
+}
 
-bool LoRaCom::setOutGain(int8_t gain) {
-  if (isFakeMode) {
-    ESP_LOGI(TAG, "Fake gain set to %d", gain);
-    return true;
-  } else {
-    // value should be bewteen -9 and 22 dBm
-    int state = radioUnion.sRadio->setOutputPower(gain);
-    if (state == RADIOLIB_ERR_NONE) {
-      ESP_LOGI(TAG, "Gain set to %d", gain);
-      return true;
-    } else {
-      ESP_LOGE(TAG, "Failed to set gain with code: %d", state);
-      return false;
+void LoRaCom::serviceReplay() {
+  int64_t now = esp_timer_get_time();
+  const TraceRecord *record;
+  while ((record = replay.peek(now)) != nullptr) {
+    // Flat out the consumer sets the pace, so a full ring is not a drop
+    if (replay.speed() == 0 && rxRing.size() >= rxRing.capacity()) break;
+    PacketSlot *slot = rxRing.acquire();
+    if (slot == nullptr) {
+      // A timed replay drops like the radio would
+      replay.pop();
+      continue;
     }
+    RxMetadata meta;
+    meta.timestampUs = now;
+    meta.rssi = record->rssi;
+    meta.snr = record->snr;
+    meta.length = record->length;
+    meta.sf = currentSF;
+    meta.bw = currentBW;
+    meta.freqMHz = currentFreq;
+    meta.cr = currentCR;
+    meta.crcOk = true;
+    memcpy(slot->data, record->data, record->length);
+    // Same header split as readoutRx
+    size_t headerOffset =
+        (PARSE_SENDER_ID_FROM_LORA_PACKETS && record->length >= LORA_ADDRESS_HEADER_LEN) ? LORA_ADDRESS_HEADER_LEN : 0;
+    rxAirtime.add(getTimeOnAirUs(record->length), millis());
+    commitRxPacket(meta, headerOffset);
+    replay.pop();
   }
 }
 
-bool LoRaCom::setFrequency(float freqMHz) {
-  if (isFakeMode) {
-    ESP_LOGI(TAG, "Fake frequency set to %.2f MHz", freqMHz);
-    return true;
-  } else {
-    // Set the frequency of the radio
-    int state = radioUnion.sRadio->setFrequency(freqMHz);
-    if (state == RADIOLIB_ERR_NONE) {
-      ESP_LOGI(TAG, "Frequency set to %.2f MHz", freqMHz);
-      return true;
-    } else {
-      ESP_LOGE(TAG, "Failed to set frequency with code: %d", state);
-      return false;
-    }
+/* =============================== NOISE SAMPLER ============================== */
+
+void LoRaCom::setNoiseSamplerEnabled(bool enabled) {
+  lockRadio();
+  if (enabled != noiseEnabled) {
+    noiseEnabled = enabled;
+    noiseWindow.clear();
+    noisePaused = false;
+    noiseNextMs = millis();
+    // Switch between duty-cycled and continuous RX once the radio is idle
+    rxRestartPending = true;
   }
+  unlockRadio();
+  if (radioTaskHandle) xTaskNotifyGive(radioTaskHandle);
+  ESP_LOGI(TAG, "Noise sampler %s", enabled ? "enabled" : "disabled");
 }
 
-bool LoRaCom::setSpreadingFactor(uint8_t spreadingFactor) {
-  if (isFakeMode) {
-    ESP_LOGI(TAG, "Fake spreading factor set to %d", spreadingFactor);
-    currentSF = spreadingFactor;
-    return true;
-  } else {
-    // Set the spreading factor of the radio
-    int state = radioUnion.sRadio->setSpreadingFactor(spreadingFactor);
-    if (state == RADIOLIB_ERR_NONE) {
-      ESP_LOGI(TAG, "Spreading factor set to %d", spreadingFactor);
-      currentSF = spreadingFactor;
-      // Force radio reconfiguration for new parameters to take effect
-      radioUnion.sRadio->startReceive();
-      return true;
+NoiseStats LoRaCom::getNoiseStats() {
+  NoiseStats stats;
+  lockRadio();
+  stats.enabled = noiseEnabled;
+  stats.lastDbm = noiseLastDbm;
+  stats.samples = noiseSamples;
+  stats.inFlight = noiseInFlight;
+  stats.rearms = noiseRearms;
+  stats.window = noiseWindow.size();
+  noiseWindow.summarise(stats.floorDbm, stats.busyPercent, stats.loraPercent);
+  unlockRadio();
+  return stats;
+}
+
+/* ================================ PING MODE ================================= */
+
+bool LoRaCom::sendPingProbe(uint16_t seq) {
+  uint8_t probe[PING_FRAME_LEN];
+  PingFrame::build(probe, PING_TYPE_PROBE, seq, 0);  // Timestamp is written by startNextTx
+  return send(probe, sizeof(probe));
+}
+
+bool LoRaCom::handlePingFrame(const uint8_t *data, size_t length, const RxMetadata &meta) {
+  PingFrame ping(data, length);
+  if (ping.isProbe()) {
+    if (!pingEchoEnabled) return false;  // Not in ping mode, the consumer sees it as a normal packet
+    TxFrame echo;
+    memcpy(echo.data, data, PING_FRAME_LEN);
+    echo.data[3] = PING_TYPE_ECHO;
+    echo.length = PING_FRAME_LEN;
+    echo.onDone = nullptr;
+    echo.context = nullptr;
+    // Front of the queue: serviceRadio starts it in the same pass that read the probe
+    if (xQueueSendToFront(txQueue, &echo, 0) != pdTRUE) {
+      txDropped++;
+      ESP_LOGW(TAG, "TX queue full, ping %u not answered", ping.seq());
     } else {
-      ESP_LOGE(TAG, "Failed to set spreading factor with code: %d", state);
-      return false;
+      pingEchoes++;
     }
+    return true;
   }
+  if (ping.isEcho() && pingOnEcho) {
+    // Both times come from esp_timer on this node, wraparound cancels out
+    uint32_t rttUs = (uint32_t)meta.timestampUs - ping.txTimeUs();
+    pingOnEcho(ping.seq(), rttUs, meta, pingContext);
+    return true;
+  }
+  return false;
 }
 
-bool LoRaCom::setBandwidth(float bandwidth) {
-  if (isFakeMode) {
-    ESP_LOGI(TAG, "Fake bandwidth set to %.2f kHz", bandwidth);
-    currentBW = bandwidth;
-    return true;
-  } else {
-    // Set the bandwidth of the radio
-    int state = radioUnion.sRadio->setBandwidth(bandwidth);
-    if (state == RADIOLIB_ERR_NONE) {
-      ESP_LOGI(TAG, "Bandwidth set to %.2f kHz", bandwidth);
-      currentBW = bandwidth;
-      // Force radio reconfiguration for new parameters to take effect
-      radioUnion.sRadio->startReceive();
-      return true;
-    } else {
-      ESP_LOGE(TAG, "Failed to set bandwidth with code: %d", state);
-      return false;
-    }
+/* ============================== RECEIVE HOPPING ============================= */
+
+void LoRaCom::startHopping() {
+  const HopPreset defaults[] = RX_HOP_PRESETS;
+  lockRadio();
+  hopPresetCount = 0;
+  for (const HopPreset &preset : defaults) {
+    if (hopPresetCount >= RX_HOP_MAX_PRESETS) break;
+    hopPresets[hopPresetCount] = preset;
+    hopStats[hopPresetCount] = HopStats();
+    hopPresetCount++;
+  }
+  hopLostUs = 0;
+  hopStartedMs = millis();
+  hopActive = hopPresetCount > 0;
+  if (hopActive) {
+    applyHopPreset(0);
+  }
+  unlockRadio();
+  ESP_LOGI(TAG, "Receive hopping started over %d presets", hopPresetCount);
+  // Let the radio task pick up the first deadline
+  if (radioTaskHandle) xTaskNotifyGive(radioTaskHandle);
+}
+
+void LoRaCom::stopHopping() {
+  lockRadio();
+  if (hopActive) {
+    hopStats[hopIndex].listenMs += millis() - hopDwellStartMs;
+    hopActive = false;
+    if (!TxMode) restartReceive();
+  }
+  unlockRadio();
+  if (hopPresetCount > 0) {
+    ESP_LOGI(TAG, "Receive hopping stopped, staying on %s", hopPresets[hopIndex].name);
+  }
+}
+
+size_t LoRaCom::getHopStats(HopPreset *presets, HopStats *stats, size_t maxCount, HopSummary *summary) {
+  lockRadio();
+  size_t count = hopPresetCount < maxCount ? hopPresetCount : maxCount;
+  for (size_t i = 0; i < count; i++) {
+    presets[i] = hopPresets[i];
+    stats[i] = hopStats[i];
+    // Include the dwell in progress
+    if (hopActive && i == hopIndex) stats[i].listenMs += millis() - hopDwellStartMs;
   }
+  if (summary) {
+    summary->active = hopActive;
+    summary->current = hopIndex;
+    summary->lostUs = hopLostUs;
+    summary->runMs = hopPresetCount ? millis() - hopStartedMs : 0;
+  }
+  unlockRadio();
+  return count;
+}
+
+bool LoRaCom::checkTxMode() {
+  return TxMode || getTxQueued() > 0;  // Return the current transmission mode status
+}
+
+bool LoRaCom::peekPacket(PacketView &view) {
+  if (!rxRing.peek(view)) {
+    return false;
+  }
+  updateRxLatency(view.meta.timestampUs);  // IRQ time to dequeue time
+  return true;
+}
+
+void LoRaCom::releasePacket() {
+  rxRing.release();
 }
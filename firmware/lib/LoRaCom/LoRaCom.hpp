@@ -5,114 +5,212 @@
 #include <Arduino.h>
 #include <RadioLib.h>
 
+#include "../lora_config.hpp"
+#include "Airtime.hpp"
+#include "NoiseFloor.hpp"
+#include "PacketRing.hpp"
+#include "PingFrame.hpp"
+#include "TraceReplay.hpp"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
-// Forward declaration for fake mode - always available for fallback
-class FakeRadio {
- public:
-  int begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, int8_t power, uint16_t preambleLength, float tcxoVoltage = 1.6, bool useRegulatorLDO = false) { return 0; }
-  int startTransmit(const char *msg) { return 0; }
-  int finishTransmit() { return 0; }
-  int startReceive() { return 0; }
-  int readData(uint8_t *buffer, size_t len) { return 0; }
-  int32_t getRSSI() { return -40; }
-  int setOutputPower(int8_t power) { return 0; }
-  int setFrequency(float freq) { return 0; }
-  int setSpreadingFactor(uint8_t sf) { return 0; }
-  int setBandwidth(float bw) { return 0; }
-  int setDio2AsRfSwitch(bool enable) { return 0; }
-  void setPacketReceivedAction(void (*func)(void)) {}
+// IRQ-to-task receive latency, in microseconds
+struct RxLatencyStats {
+  uint32_t lastUs = 0;
+  uint32_t minUs = 0;
+  uint32_t maxUs = 0;
+  uint64_t totalUs = 0;
+  uint32_t count = 0;
+
+  uint32_t avgUs() const { return count ? (uint32_t)(totalUs / count) : 0; }
+};
+
+// SX1262 FIFO limit for one LoRa packet
+#define LORA_MAX_PACKET_LEN 255
+// to(4) + from(4) of the Meshtastic header, skipped before the payload
+#define LORA_ADDRESS_HEADER_LEN 8
+
+// Own TX airtime against the regulatory budget, and total channel airtime,
+// over the last TX_DUTY_CYCLE_WINDOW_MS
+struct AirtimeStats {
+  uint64_t txUs = 0;
+  uint64_t rxUs = 0;
+  uint64_t budgetUs = 0;
+  uint32_t windowMs = 0;
+  uint32_t lastTxToaUs = 0;
+  uint32_t lastTxAirUs = 0;  // Measured, TX start to the TX_DONE interrupt
+  uint32_t deferred = 0;  // Times the queue head had to wait for budget
+
+  uint64_t remainingUs() const { return txUs < budgetUs ? budgetUs - txUs : 0; }
+  float txUtilisation() const { return windowMs ? (txUs / 10.0f) / windowMs : 0; }  // percent
+  float channelUtilisation() const { return windowMs ? ((txUs + rxUs) / 10.0f) / windowMs : 0; }  // percent
+};
+
+// Listen-before-talk counters
+struct LbtStats {
+  uint32_t busy = 0;       // CAD scans that found LoRa activity
+  uint32_t deferred = 0;   // Frames that had to wait at least once
+  uint32_t forced = 0;     // Frames sent after LBT_MAX_ATTEMPTS busy scans
+  uint32_t backoffMs = 0;  // Total backoff time
+};
+
+// One receive configuration visited by the hopping scheduler
+struct HopPreset {
+  const char *name;
+  float freqMHz;
+  uint8_t sf;
+  float bwKHz;
+  uint8_t cr;
+  uint8_t syncWord;
+  uint32_t dwellMs;
 };
 
+// Capture statistics of one hopping preset
+struct HopStats {
+  uint32_t packets = 0;
+  uint32_t crcErrors = 0;
+  uint32_t visits = 0;
+  uint32_t holds = 0;     // Dwells extended because a packet was in flight
+  uint64_t listenMs = 0;
+};
+
+// Background noise floor and channel occupancy over the last NOISE_WINDOW_SAMPLES
+struct NoiseStats {
+  bool enabled = false;
+  float floorDbm = 0;
+  float lastDbm = 0;
+  float busyPercent = 0;  // Energy above floor + NOISE_BUSY_MARGIN_DB, no LoRa preamble
+  float loraPercent = 0;  // Samples skipped because a LoRa packet was in flight
+  uint32_t samples = 0;
+  uint32_t inFlight = 0;
+  uint32_t rearms = 0;    // Receiver re-armed after a preamble that never became a packet
+  size_t window = 0;
+};
+
+struct HopSummary {
+  bool active = false;
+  uint8_t current = 0;
+  uint64_t lostUs = 0;    // Time spent reconfiguring instead of listening
+  uint32_t runMs = 0;
+};
+
+// Called from the radio task when a queued frame has left the air (or failed)
+typedef void (*TxDoneCallback)(bool success, uint32_t durationMs, void *context);
+// Called from the radio task for every ping echo, rttUs runs from probe TX start to echo RX_DONE
+typedef void (*PingEchoCallback)(uint16_t seq, uint32_t rttUs, const RxMetadata &meta, void *context);
+
+// Radio-independent half of the LoRa link: TX queue, RX ring, airtime, LBT
+// and hopping state, trace replay. The radio itself is reached through
+// LoRaComT<Radio> (LoRaComT.hpp), whose radio task runs the hot path with the
+// backend bound at compile time; only configuration calls are virtual.
 class LoRaCom {
  public:
   LoRaCom();
+  virtual ~LoRaCom();
 
+  // True for backends without hardware (FakeRadio)
+  virtual bool isSimulated() const = 0;
 
+  // Queues a frame for transmission and returns at once. False when the frame
+  // is empty, longer than LORA_MAX_PACKET_LEN or the TX queue is full.
+  bool send(const uint8_t *data, size_t length, TxDoneCallback onDone = nullptr,
+            void *context = nullptr);
+  void sendMessage(const char *msg);  // text wrapper around send()
+  // Oldest received packet, read in place from the RX ring. The view stays
+  // valid until releasePacket() is called.
+  bool peekPacket(PacketView &view);
+  void releasePacket();
+  virtual int32_t getRssi() = 0;
 
-  bool beginFake(uint8_t CLK, uint8_t MISO, uint8_t MOSI, uint8_t csPin,
-                 uint8_t intPin, uint8_t RST, float freqMHz, int8_t power,
-                 int8_t BUSY = -1) {
-    radioUnion.fRadio = new FakeRadio();
-    int state = radioUnion.fRadio->begin(freqMHz, 500, 7, 5, 0x34, power, 20);
-    if (state == 0) {
-      ESP_LOGI(TAG, "***FAKE LoRa MODE ENABLED - NO HARDWARE DETECTED***");
-      radioInitialised = true;
-      isFakeMode = true;
-      return true;
-    } else {
-      ESP_LOGE(TAG, "Fake LoRa initialisation FAILED!");
-      return false;
-    }
-  }
+  virtual bool setOutGain(int8_t gain) = 0;
+  virtual bool setFrequency(float freqMHz) = 0;
 
-  template <typename RadioType>
-  bool begin(uint8_t CLK, uint8_t MISO, uint8_t MOSI, uint8_t csPin,
-             uint8_t intPin, uint8_t RST, float freqMHz, int8_t power,
-             int8_t BUSY = -1) {
-    SPI.begin(CLK, MISO, MOSI, csPin);
-
-    radioUnion.sRadio = new RadioType((BUSY == -1) ? new Module(csPin, intPin, RST)
-                                                   : new Module(csPin, intPin, RST, BUSY));
-
-#if defined(SX126X_DIO3_TCXO_VOLTAGE)
-    // SX1262::begin(freq, bw, sf, cr, syncWord, power, preambleLength, tcxoVoltage)
-    // freq: 868.06 MHz, bw: 125 kHz, sf: 11, cr: 4/5, syncWord: 0x12, power: 22 dBm, preamble: 20, tcxo: 1.8V
-    int state = radioUnion.sRadio->begin(freqMHz, 250.0, 11, 5, 0x12,
-                                         power, 20, SX126X_DIO3_TCXO_VOLTAGE);
-#else
-    // SX1262::begin(freq, bw, sf, cr, syncWord, power, preambleLength)
-    // freq: 868.075 MHz, bw: 250 kHz, sf: 11, cr: 4/5, syncWord: 0x12, power: 20 dBm, preamble: 20
-    int state = radioUnion.sRadio->begin(freqMHz, 250.0, 11, 5, 0x12,
-                                         power, 20);
-#endif
+  virtual bool setSpreadingFactor(uint8_t spreadingFactor) = 0;
+  virtual bool setBandwidth(float bandwidth) = 0;
 
-#if defined(SX126X_DIO2_AS_RF_SWITCH)
-    // Set DIO2 as RF switch for antenna multiplexing
-    state |= radioUnion.sRadio->setDio2AsRfSwitch(true);
-#endif
+  virtual void setCodingRate(int cr) = 0;
+  virtual void setSyncWord(uint8_t sw) = 0;
+
+  bool checkTxMode();  // true while a frame is on air or waiting in the TX queue
 
-    radioUnion.sRadio->setPacketReceivedAction(RxTxCallback);
-    // radio->setPacketSentAction(TxCallback);
-
-    state |= radioUnion.sRadio->startReceive();
-    if (state == RADIOLIB_ERR_NONE) {
-      ESP_LOGI(TAG, "LoRa initialised successfully!");
-      radioInitialised = true;
-      isFakeMode = false;
-      return true;
-    } else {
-      ESP_LOGE(TAG, "LoRa initialisation FAILED! Code: %d", state);
-      return false;
-    }
+  // Time on air of a packet of this length at the current SF/BW/CR/preamble
+  uint32_t getTimeOnAirUs(size_t length) const {
+    return loraTimeOnAirUs(currentSF, (uint32_t)(currentBW * 1000), currentCR, currentPreamble, length);
   }
+  AirtimeStats getAirtimeStats();
+
+  // Receive hopping over RX_HOP_PRESETS on a timetable. A dwell is extended
+  // while a preamble or header has been detected, up to RX_HOP_MAX_HOLD_MS.
+  void startHopping();
+  void stopHopping();
+  bool isHopping() const { return hopActive; }
+  // Copies up to maxCount presets and their statistics, returns the count
+  size_t getHopStats(HopPreset *presets, HopStats *stats, size_t maxCount, HopSummary *summary);
+
+  // Listen-before-talk: CAD before every frame, random backoff while busy
+  void setLbtEnabled(bool enabled) { lbtEnabled = enabled; }
+  bool isLbtEnabled() const { return lbtEnabled; }
+  LbtStats getLbtStats() const { return lbtStats; }
+  // Fake mode only: the next scans report a busy channel
+  virtual void setFakeBusyScans(uint8_t scans) = 0;
+
+  // Fake mode only: feed a recorded trace (see TraceReplay) into the RX ring
+  // instead of the periodic fake message. speed 1 is real time, 0 flat out.
+  bool startReplay(const char *path, float speed, bool loop);
+  void stopReplay();
+  bool isReplaying() const { return replay.isActive(); }
+  uint32_t getReplayPlayed() const { return replay.getPlayed(); }
+  uint32_t getReplayBadLines() const { return replay.getBadLines(); }
+  uint32_t getReplayLoops() const { return replay.getLoops(); }
 
-  void sendMessage(const char *msg);  // overloaded function
-  bool getMessage(char *buffer, size_t len, int* receivedLen = nullptr);
-  int32_t getRssi();
+  // Noise sampler: instantaneous RSSI every NOISE_SAMPLE_INTERVAL_MS while
+  // receiving and no preamble or header is latched. Needs continuous RX.
+  void setNoiseSamplerEnabled(bool enabled);
+  bool isNoiseSamplerEnabled() const { return noiseEnabled; }
+  NoiseStats getNoiseStats();
 
-  bool setOutGain(int8_t gain);
-  bool setFrequency(float freqMHz);
+  // Ping mode. With echo enabled a received probe is answered from the radio
+  // task right after readout, ahead of anything else in the TX queue.
+  void setPingEchoEnabled(bool enabled) { pingEchoEnabled = enabled; }
+  bool isPingEchoEnabled() const { return pingEchoEnabled; }
+  uint32_t getPingEchoes() const { return pingEchoes; }
+  // Probe is stamped with the time it starts transmitting, not when queued
+  bool sendPingProbe(uint16_t seq);
+  void setPingEchoHandler(PingEchoCallback onEcho, void *context) {
+    pingContext = context;
+    pingOnEcho = onEcho;
+  }
+
+  size_t getTxQueued() const { return txQueue ? uxQueueMessagesWaiting(txQueue) : 0; }
+  uint32_t getTxSent() const { return txSent; }
+  uint32_t getTxFailed() const { return txFailed; }
+  uint32_t getTxDropped() const { return txDropped; }
 
-  bool setSpreadingFactor(uint8_t spreadingFactor);
-  bool setBandwidth(float bandwidth);
+  // Radio task: woken by the DIO1 interrupt, reads RX_DONE into a ring slot
+  // and re-arms the receiver before the consumer gets to the packet
+  void startRadioTask();
+  void stopRadioTask();
 
-  void setCodingRate(int cr) { currentCR = cr; if (!isFakeMode) radioUnion.sRadio->setCodingRate(cr); }
-  void setSyncWord(uint8_t sw) { currentSyncWord = sw; if (!isFakeMode) radioUnion.sRadio->setSyncWord(sw); }
+  // Task (packet consumer) notified whenever a packet lands in the ring
+  void setRxNotifyTask(TaskHandle_t task) { rxNotifyTask = task; }
+  RxLatencyStats getRxLatencyStats() const { return rxLatency; }
 
-  bool checkTxMode();
+  size_t getRxRingUsed() const { return rxRing.size(); }
+  size_t getRxRingCapacity() const { return rxRing.capacity(); }
+  uint32_t getRxRingDropped() const { return rxRing.getDropped(); }
+  uint32_t getRxRingHighWater() const { return rxRing.getHighWater(); }
 
+  float getCurrentFreq() { return currentFreq; }
   uint8_t getCurrentSF() { return currentSF; }
   float getCurrentBW() { return currentBW; }
   int getCurrentCR() { return currentCR; }
   uint8_t getSyncWord() { return currentSyncWord; }
 
- private:
-  union RadioUnion {
-    FakeRadio* fRadio;
-    SX1262* sRadio;
-  } radioUnion;
-  bool isFakeMode = false; // true if using FakeRadio, false if SX1262
+ protected:
   static LoRaCom *instance;
 
   bool radioInitialised = false;
@@ -123,16 +221,97 @@ class LoRaCom {
 
   volatile bool TxFinished = false;
 
-  unsigned long txStartTime = 0;
+  int64_t txStartUs = 0;  // esp_timer time the current frame was handed to the radio
+  volatile int64_t txDoneIrqUs = 0;  // esp_timer time of the last TX done interrupt
+  uint32_t lastTxAirUs = 0;
+
+  struct TxFrame {
+    uint8_t data[LORA_MAX_PACKET_LEN];
+    size_t length;
+    TxDoneCallback onDone;
+    void *context;
+  };
+  QueueHandle_t txQueue = nullptr;
+  // Completion of the frame currently on air
+  TxDoneCallback txOnDone = nullptr;
+  void *txContext = nullptr;
+  volatile uint32_t txSent = 0;
+  volatile uint32_t txFailed = 0;
+  volatile uint32_t txDropped = 0;
+
+  AirtimeWindow txAirtime{TX_DUTY_CYCLE_WINDOW_MS};
+  AirtimeWindow rxAirtime{TX_DUTY_CYCLE_WINDOW_MS};
+  uint32_t lastTxToaUs = 0;
+  uint32_t txDeferred = 0;
+  bool txWaitingForBudget = false;
+  // Checked before CAD, so a scan is only spent on a frame that can go out
+  bool txBudgetAllows(size_t length);
+  void chargeTxBudget(size_t length);
+
+  volatile bool lbtEnabled = LBT_ENABLED;
+  volatile bool cadActive = false;  // DIO1 reports CAD_DONE, not RX, while set
+  uint8_t lbtAttempts = 0;          // Busy scans for the current queue head
+  uint32_t txHoldUntilMs = 0;       // End of the current backoff
+  LbtStats lbtStats;
+  uint32_t radioWaitMs();
+
+  HopPreset hopPresets[RX_HOP_MAX_PRESETS];
+  HopStats hopStats[RX_HOP_MAX_PRESETS];
+  uint8_t hopPresetCount = 0;
+  volatile bool hopActive = false;
+  uint8_t hopIndex = 0;
+  uint32_t hopDwellStartMs = 0;
+  uint32_t hopDeadlineMs = 0;
+  uint32_t hopStartedMs = 0;
+  uint64_t hopLostUs = 0;
+  TraceReplay replay;
+  void serviceReplay();
+
+  volatile bool noiseEnabled = NOISE_SAMPLER_ENABLED;
+  NoiseWindow noiseWindow;
+  uint32_t noiseNextMs = 0;
+  uint32_t noisePausedSinceMs = 0;
+  bool noisePaused = false;
+  float noiseLastDbm = 0;
+  uint32_t noiseSamples = 0;
+  uint32_t noiseInFlight = 0;
+  uint32_t noiseRearms = 0;
+
+  volatile bool pingEchoEnabled = PING_ECHO_ENABLED;
+  volatile uint32_t pingEchoes = 0;
+  PingEchoCallback pingOnEcho = nullptr;
+  void *pingContext = nullptr;
+  bool handlePingFrame(const uint8_t *data, size_t length, const RxMetadata &meta);
+
+  virtual void applyHopPreset(uint8_t index) = 0;
+  bool rxRestartPending = false;  // TX ended, RX not re-armed yet
+
+  TaskHandle_t radioTaskHandle = nullptr;
+  TaskHandle_t rxNotifyTask = nullptr;
+  volatile int64_t rxIrqTimeUs = 0;  // esp_timer time of the last RX interrupt
+  RxLatencyStats rxLatency;
+  unsigned long lastFakeRxTime = 0;
+
+  PacketRing<LORA_RX_RING_SIZE> rxRing;
+
+  // Serialises SPI access between the radio task and callers of the setters
+  SemaphoreHandle_t radioMutex = nullptr;
+  void lockRadio() { xSemaphoreTake(radioMutex, portMAX_DELAY); }
+  void unlockRadio() { xSemaphoreGive(radioMutex); }
+
+  static void radioTaskWrapper(void *param);
+  virtual void radioTask() = 0;
+  virtual void restartReceive() = 0;
+  void commitRxPacket(const RxMetadata &meta, size_t headerOffset);
+  void updateRxLatency(int64_t irqTimeUs);
 
   // Current LoRa settings for logging
+  float currentFreq = LORA_FREQUENCY;
   uint8_t currentSF = 11;
   float currentBW = 250.0;
   int currentCR = 5;
   uint8_t currentSyncWord = 0x12;
-
-  // Last sender ID parsed from received packet
-  uint32_t lastSenderId = 0;
+  uint16_t currentPreamble = 20;  // Preamble passed to begin()
 
   static void RxTxCallback(void);
 
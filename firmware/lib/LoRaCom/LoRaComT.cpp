@@ -0,0 +1,536 @@
+// LoRaComT.cpp
+#include "LoRaComT.hpp"
+
+// While a packet is in flight at the end of a dwell, check again after this long
+#define HOP_HOLD_POLL_MS 20
+
+// Fake mode: interval between simulated receptions
+#define FAKE_RX_INTERVAL_MS 10000
+
+template <typename Radio>
+bool LoRaComT<Radio>::begin(uint8_t CLK, uint8_t MISO, uint8_t MOSI, uint8_t csPin,
+                            uint8_t intPin, uint8_t RST, float freqMHz, int8_t power,
+                            int8_t BUSY) {
+  int state = radio.begin(CLK, MISO, MOSI, csPin, intPin, RST, freqMHz, power, BUSY);
+  if (state == RADIOLIB_ERR_NONE) {
+    radio.setIrqAction(RxTxCallback);
+    state = radio.startReceive(false);
+  }
+  currentFreq = freqMHz;
+  if (state != RADIOLIB_ERR_NONE) {
+    ESP_LOGE(TAG, "LoRa initialisation FAILED! Code: %d", state);
+    return false;
+  }
+  if constexpr (Radio::SIMULATED) {
+    ESP_LOGI(TAG, "***FAKE LoRa MODE ENABLED - NO HARDWARE DETECTED***");
+  } else {
+    ESP_LOGI(TAG, "LoRa initialised successfully!");
+  }
+  radioInitialised = true;
+  return true;
+}
+
+/* ================================ RADIO TASK ================================ */
+
+template <typename Radio>
+void LoRaComT<Radio>::radioTask() {
+  while (true) {
+    serviceRadio();
+    // Sleep until DIO1 reports RX/TX done, the timeout is only a safety net
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(radioWaitMs()));
+  }
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::serviceRadio() {
+  if constexpr (Radio::SIMULATED) {
+    serviceSimulated();
+    return;
+  }
+
+  if (!radioInitialised) return;
+
+  lockRadio();
+  // Check if transmission finished
+  if (TxFinished) {
+    finishTx();
+  }
+  if (RxFlag) {
+    readoutRx();
+  }
+  // Start the next queued frame, right after TX_DONE when frames are back to back
+  bool transmitting = TxMode || startNextTx();
+  if (!transmitting && rxRestartPending) {
+    restartReceive();
+  }
+  if (!transmitting && hopActive) {
+    serviceHopping();
+  }
+  if (!transmitting && !rxRestartPending && noiseEnabled) {
+    serviceNoiseSampler();
+  }
+  unlockRadio();
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::serviceSimulated() {
+  if (replay.isActive()) {
+    lockRadio();
+    serviceReplay();
+    unlockRadio();
+  } else if (millis() - lastFakeRxTime >= FAKE_RX_INTERVAL_MS) {  // Simulate receiving a message occasionally
+    lastFakeRxTime = millis();
+    const char *fakeMsg = "Fake received message";
+    PacketSlot *slot = rxRing.acquire();
+    if (slot) {
+      RxMetadata meta;
+      meta.timestampUs = esp_timer_get_time();
+      meta.rssi = radio.packetRssi();
+      meta.length = strlen(fakeMsg);
+      meta.sf = currentSF;
+      meta.bw = currentBW;
+      meta.freqMHz = currentFreq;
+      meta.cr = currentCR;
+      meta.crcOk = true;
+      memcpy(slot->data, fakeMsg, meta.length);
+      commitRxPacket(meta, 0);
+    }
+  }
+  // Frames leave the fake radio instantly, still within the airtime budget
+  TxFrame frame;
+  while (xQueuePeek(txQueue, &frame, 0) == pdTRUE && txBudgetAllows(frame.length) && lbtAllowsTx()) {
+    xQueueReceive(txQueue, &frame, 0);
+    chargeTxBudget(frame.length);
+    ESP_LOGI(TAG, "Fake transmitting %u bytes", (unsigned)frame.length);
+    PingFrame ping(frame.data, frame.length);
+    if (ping.isProbe()) {
+      // No peer in fake mode, the probe comes straight back as its own echo
+      RxMetadata meta;
+      meta.timestampUs = esp_timer_get_time();
+      meta.rssi = radio.packetRssi();
+      meta.length = frame.length;
+      PingFrame::setTxTime(frame.data, (uint32_t)meta.timestampUs);
+      frame.data[3] = PING_TYPE_ECHO;
+      handlePingFrame(frame.data, frame.length, meta);
+    }
+    txSent++;
+    if (frame.onDone) frame.onDone(true, 0, frame.context);
+  }
+  if (noiseEnabled) {
+    lockRadio();
+    serviceNoiseSampler();
+    unlockRadio();
+  }
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::finishTx() {
+  TxFinished = false;
+  // Both ends are esp_timer stamps, the task's wakeup delay is not part of it
+  uint32_t txDurationUs = (uint32_t)(txDoneIrqUs - txStartUs);
+  unsigned long txDuration = txDurationUs / 1000;
+  int state = radio.finishTransmit();
+  TxMode = false;
+  bool success = (state == RADIOLIB_ERR_NONE);
+  if (success) {
+    txSent++;
+    lastTxAirUs = txDurationUs;
+    ESP_LOGI(TAG, "Tx done: %lu us SF%d BW%.0f", (unsigned long)txDurationUs, currentSF, currentBW);
+  } else {
+    txFailed++;
+    ESP_LOGE(TAG, "Transmission failed, code: %d", state);
+  }
+  if (txOnDone) {
+    TxDoneCallback onDone = txOnDone;
+    txOnDone = nullptr;
+    onDone(success, txDuration, txContext);
+  }
+  // Receive is re-armed only once the TX queue is empty
+  rxRestartPending = true;
+}
+
+template <typename Radio>
+bool LoRaComT<Radio>::startNextTx() {
+  // A packet waiting in the FIFO is read out first, the radio task comes back for TX
+  if (RxFlag) return false;
+
+  TxFrame frame;
+  if (xQueuePeek(txQueue, &frame, 0) != pdTRUE) return false;
+  // Over the duty-cycle budget the frame stays queued, the radio task retries on its next wakeup.
+  // Checked first: a clear CAD leaves the radio in standby and has to be followed by the TX.
+  if (!txBudgetAllows(frame.length)) return false;
+  if (!lbtAllowsTx()) return false;
+  xQueueReceive(txQueue, &frame, 0);
+  chargeTxBudget(frame.length);
+
+  TxMode = true;
+  txStartUs = esp_timer_get_time();  // Record transmission start time
+  txOnDone = frame.onDone;
+  txContext = frame.context;
+  if (PingFrame(frame.data, frame.length).isProbe()) {
+    // Queueing, LBT and budget waits are not part of the round trip
+    PingFrame::setTxTime(frame.data, (uint32_t)txStartUs);
+  }
+  int state = radio.startTransmit(frame.data, frame.length);
+  if (state == RADIOLIB_ERR_NONE) {
+    ESP_LOGD(TAG, "Transmitting %u bytes", (unsigned)frame.length);
+    return true;
+  }
+
+  ESP_LOGE(TAG, "Failed to begin transmission, code: %d", state);
+  TxMode = false;  // Reset flag on failure
+  txFailed++;
+  txOnDone = nullptr;
+  if (frame.onDone) frame.onDone(false, 0, frame.context);
+  rxRestartPending = true;
+  return false;
+}
+
+template <typename Radio>
+bool LoRaComT<Radio>::channelBusy() {
+  // DIO1 reports CAD_DONE while scanning, the ISR must not take it for RX
+  cadActive = true;
+  bool busy = radio.channelBusy();
+  cadActive = false;
+  return busy;
+}
+
+template <typename Radio>
+bool LoRaComT<Radio>::lbtAllowsTx() {
+  if (!lbtEnabled) return true;
+  uint32_t now = millis();
+  if ((int32_t)(txHoldUntilMs - now) > 0) return false;  // Still backing off
+
+  if (!channelBusy()) {
+    lbtAttempts = 0;
+    return true;
+  }
+
+  lbtStats.busy++;
+  if (lbtAttempts == 0) lbtStats.deferred++;
+  if (lbtAttempts >= LBT_MAX_ATTEMPTS) {
+    // Do not starve the queue on a permanently busy channel
+    ESP_LOGW(TAG, "Channel busy after %d CAD attempts, transmitting anyway", lbtAttempts);
+    lbtStats.forced++;
+    lbtAttempts = 0;
+    return true;
+  }
+
+  // Random backoff, window doubles with every busy scan
+  uint32_t window = (uint32_t)LBT_BACKOFF_MIN_MS << lbtAttempts;
+  if (window > LBT_BACKOFF_MAX_MS) window = LBT_BACKOFF_MAX_MS;
+  uint32_t backoffMs = LBT_BACKOFF_MIN_MS + random(window);
+  lbtAttempts++;
+  lbtStats.backoffMs += backoffMs;
+  txHoldUntilMs = now + backoffMs;
+  ESP_LOGD(TAG, "Channel busy (CAD), backoff %lu ms, attempt %d", (unsigned long)backoffMs, lbtAttempts);
+
+  // CAD leaves the radio in standby, keep listening while we wait
+  startRx();
+  return false;
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::restartReceive() {
+  rxRestartPending = false;
+  if (hopActive || noiseEnabled) {
+    // Hopping and the noise sampler need continuous RX with the preamble IRQ latched
+    if (startRx() != RADIOLIB_ERR_NONE) ESP_LOGE(TAG, "Failed to restart reception");
+    return;
+  }
+#if DUTY_CYCLE_RECEPTION == 1
+  // Use Meshtastic-style duty cycle reception for power efficiency
+  ESP_LOGD(TAG, "Using duty cycle reception after TX");
+  int state = radio.startReceiveDutyCycle();
+#else
+  // Use continuous receive for traffic testing
+  ESP_LOGD(TAG, "Using continuous reception after TX");
+  int state = radio.startReceive(false);
+#endif
+  if (state != RADIOLIB_ERR_NONE) {
+    ESP_LOGE(TAG, "Failed to restart reception, code: %d", state);
+  }
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::readoutRx() {
+  int state;  // Объявляем переменную state в начале блока
+  size_t headerOffset = 0;
+  RxMetadata meta;
+
+  // Clear before reading so an interrupt arriving during readout is not lost
+  RxFlag = false;
+  meta.timestampUs = rxIrqTimeUs;
+
+  PacketSlot *slot = rxRing.acquire();
+  if (slot == nullptr) {
+    // Consumer is behind, leave the packet in the FIFO and listen again
+    startRx();
+    ESP_LOGW(TAG, "RX ring full (%u slots), packet dropped, total dropped: %lu",
+             (unsigned)rxRing.capacity(), (unsigned long)rxRing.getDropped());
+    return;
+  }
+  // One byte is kept free for the terminator written on commit
+  const size_t maxLen = LORA_PACKET_SLOT_SIZE - 1;
+  size_t actualLen = 0;
+
+#if PARSE_SENDER_ID_FROM_LORA_PACKETS == 1
+  // NEW METHOD: Parse sender_id from packet header when enabled
+  size_t packetLength = radio.packetLength();
+  if (packetLength > maxLen) packetLength = maxLen;
+  // Read the whole packet including header straight into the slot
+  state = radio.readData(slot->data, packetLength);
+  actualLen = packetLength;
+
+  if (packetLength >= LORA_ADDRESS_HEADER_LEN) {
+    // Payload starts after the addresses, downstream reads them in place
+    headerOffset = LORA_ADDRESS_HEADER_LEN;
+  } else {
+    ESP_LOGI(TAG, "Short packet received (%u bytes), no address header", (unsigned)packetLength);
+  }
+#else
+  // OLD METHOD: Original logic when parsing is disabled - no getPacketLength() call
+  memset(slot->data, 0, maxLen);
+  state = radio.readData(slot->data, maxLen);
+#endif
+
+  // A CRC error still leaves a packet behind, keep it so it can be counted
+  meta.crcOk = (state != RADIOLIB_ERR_CRC_MISMATCH);
+  if (state == RADIOLIB_ERR_CRC_MISMATCH) state = RADIOLIB_ERR_NONE;
+
+  // Signal figures belong to the packet just read, take them before RX restarts
+  meta.rssi = radio.packetRssi();
+  meta.snr = radio.packetSnr();
+  meta.freqErrorHz = radio.frequencyError();
+  meta.sf = currentSF;
+  meta.bw = currentBW;
+  meta.freqMHz = currentFreq;
+  meta.cr = currentCR;
+
+  meta.preset = hopActive ? hopIndex : -1;
+  state |= startRx();
+  bool result = (state == RADIOLIB_ERR_NONE);
+
+  if (result) {
+    // Determine actual packet length
+#if PARSE_SENDER_ID_FROM_LORA_PACKETS == 0
+    // Original length detection when parsing disabled
+    actualLen = 0;
+    for (size_t i = 0; i < maxLen; i++) {
+      if (slot->data[i] == '\0') {
+        actualLen = i;
+        break;
+      }
+    }
+    if (actualLen == 0) {  // No null terminator found, assume we got data
+      // This is tricky - RadioLib doesn't return actual received length
+      // We'll use a heuristic or assume received something meaningful
+      actualLen = maxLen;  // Default assumption
+    }
+#endif
+    meta.length = actualLen;
+    if (hopActive) {
+      if (meta.crcOk) hopStats[hopIndex].packets++;
+      else hopStats[hopIndex].crcErrors++;
+    }
+    rxAirtime.add(getTimeOnAirUs(actualLen), millis());  // Channel occupancy by other nodes
+    if (meta.crcOk && handlePingFrame(slot->data, actualLen, meta)) {
+      return;  // Answered or measured here, the slot is not committed
+    }
+    commitRxPacket(meta, headerOffset);
+  } else {
+    ESP_LOGE(TAG, "Reception failed, code: %d", state);
+  }
+}
+
+/* =============================== NOISE SAMPLER ============================== */
+
+template <typename Radio>
+void LoRaComT<Radio>::serviceNoiseSampler() {
+  uint32_t now = millis();
+  if ((int32_t)(now - noiseNextMs) < 0) return;
+  noiseNextMs = now + NOISE_SAMPLE_INTERVAL_MS;
+
+  if (radio.packetInFlight()) {
+    // A packet is arriving, leave the receiver alone and count the channel as busy
+    if (!noisePaused) {
+      noisePaused = true;
+      noisePausedSinceMs = now;
+    }
+    noiseWindow.addInFlight();
+    noiseInFlight++;
+    // A false preamble stays latched forever, re-arm once even the longest packet would be over
+    if (now - noisePausedSinceMs > getTimeOnAirUs(LORA_MAX_PACKET_LEN) / 1000 + NOISE_SAMPLE_INTERVAL_MS) {
+      startRx();
+      noisePaused = false;
+      noiseRearms++;
+    }
+    return;
+  }
+  noisePaused = false;
+
+  float rssi = radio.channelRssi();
+  noiseLastDbm = rssi;
+  noiseWindow.addSample(rssi);
+  noiseSamples++;
+}
+
+/* ============================== RECEIVE HOPPING ============================= */
+
+template <typename Radio>
+int LoRaComT<Radio>::startRx() {
+  return radio.startReceive(hopActive || noiseEnabled);
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::serviceHopping() {
+  uint32_t now = millis();
+  if ((int32_t)(now - hopDeadlineMs) < 0) return;
+
+  const HopPreset &preset = hopPresets[hopIndex];
+  HopStats &stats = hopStats[hopIndex];
+  // Preamble or header seen: a packet is in flight, stay until RX_DONE or the hold limit
+  if ((now - hopDwellStartMs) < preset.dwellMs + RX_HOP_MAX_HOLD_MS && radio.packetInFlight()) {
+    if (hopDeadlineMs == hopDwellStartMs + preset.dwellMs) stats.holds++;
+    hopDeadlineMs = now + HOP_HOLD_POLL_MS;
+    return;
+  }
+
+  stats.listenMs += now - hopDwellStartMs;
+  applyHopPreset((hopIndex + 1) % hopPresetCount);
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::applyHopPreset(uint8_t index) {
+  const HopPreset &preset = hopPresets[index];
+  int64_t startUs = esp_timer_get_time();
+  // Register writes only, RX restarts once with all parameters in place
+  int state = radio.standby();
+  state |= radio.setFrequency(preset.freqMHz);
+  state |= radio.setSpreadingFactor(preset.sf);
+  state |= radio.setBandwidth(preset.bwKHz);
+  state |= radio.setCodingRate(preset.cr);
+  state |= radio.setSyncWord(preset.syncWord);
+  state |= startRx();
+  if (state != RADIOLIB_ERR_NONE) {
+    ESP_LOGE(TAG, "Hop to %s failed, code: %d", preset.name, state);
+  }
+  currentFreq = preset.freqMHz;
+  currentSF = preset.sf;
+  currentBW = preset.bwKHz;
+  currentCR = preset.cr;
+  currentSyncWord = preset.syncWord;
+
+  hopLostUs += esp_timer_get_time() - startUs;  // Time deaf while reconfiguring
+  hopIndex = index;
+  hopStats[index].visits++;
+  hopDwellStartMs = millis();
+  hopDeadlineMs = hopDwellStartMs + preset.dwellMs;
+  ESP_LOGD(TAG, "Hop to %s (SF%d BW%.0f)", preset.name, preset.sf, preset.bwKHz);
+}
+
+/* ================================ SETTERS ================================ */
+
+template <typename Radio>
+int32_t LoRaComT<Radio>::getRssi() {
+  lockRadio();
+  int32_t rssi = radio.packetRssi();  // Return the last received signal strength
+  unlockRadio();
+  return rssi;
+}
+
+template <typename Radio>
+bool LoRaComT<Radio>::setOutGain(int8_t gain) {
+  // value should be bewteen -9 and 22 dBm
+  lockRadio();
+  int state = radio.setOutputPower(gain);
+  unlockRadio();
+  if (state == RADIOLIB_ERR_NONE) {
+    ESP_LOGI(TAG, "Gain set to %d", gain);
+    return true;
+  } else {
+    ESP_LOGE(TAG, "Failed to set gain with code: %d", state);
+    return false;
+  }
+}
+
+template <typename Radio>
+bool LoRaComT<Radio>::setFrequency(float freqMHz) {
+  // Set the frequency of the radio
+  lockRadio();
+  int state = radio.setFrequency(freqMHz);
+  unlockRadio();
+  if (state == RADIOLIB_ERR_NONE) {
+    ESP_LOGI(TAG, "Frequency set to %.2f MHz", freqMHz);
+    currentFreq = freqMHz;
+    return true;
+  } else {
+    ESP_LOGE(TAG, "Failed to set frequency with code: %d", state);
+    return false;
+  }
+}
+
+template <typename Radio>
+bool LoRaComT<Radio>::setSpreadingFactor(uint8_t spreadingFactor) {
+  // Set the spreading factor of the radio
+  lockRadio();
+  int state = radio.setSpreadingFactor(spreadingFactor);
+  if (state == RADIOLIB_ERR_NONE) {
+    ESP_LOGI(TAG, "Spreading factor set to %d", spreadingFactor);
+    currentSF = spreadingFactor;
+    // Force radio reconfiguration for new parameters to take effect, keeping
+    // the preamble IRQ that hopping and the noise sampler rely on
+    startRx();
+    unlockRadio();
+    return true;
+  } else {
+    unlockRadio();
+    ESP_LOGE(TAG, "Failed to set spreading factor with code: %d", state);
+    return false;
+  }
+}
+
+template <typename Radio>
+bool LoRaComT<Radio>::setBandwidth(float bandwidth) {
+  // Set the bandwidth of the radio
+  lockRadio();
+  int state = radio.setBandwidth(bandwidth);
+  if (state == RADIOLIB_ERR_NONE) {
+    ESP_LOGI(TAG, "Bandwidth set to %.2f kHz", bandwidth);
+    currentBW = bandwidth;
+    // Force radio reconfiguration for new parameters to take effect, keeping
+    // the preamble IRQ that hopping and the noise sampler rely on
+    startRx();
+    unlockRadio();
+    return true;
+  } else {
+    unlockRadio();
+    ESP_LOGE(TAG, "Failed to set bandwidth with code: %d", state);
+    return false;
+  }
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::setCodingRate(int cr) {
+  currentCR = cr;
+  lockRadio();
+  radio.setCodingRate(cr);
+  unlockRadio();
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::setSyncWord(uint8_t sw) {
+  currentSyncWord = sw;
+  lockRadio();
+  radio.setSyncWord(sw);
+  unlockRadio();
+}
+
+template <typename Radio>
+void LoRaComT<Radio>::setFakeBusyScans(uint8_t scans) {
+  if constexpr (Radio::SIMULATED) radio.busyScans = scans;
+}
+
+// Backends built into the firmware
+template class LoRaComT<Sx126xRadio<SX1262>>;
+template class LoRaComT<FakeRadio>;
@@ -0,0 +1,57 @@
+// LoRaComT.hpp
+#ifndef LoRaComT_h
+#define LoRaComT_h
+
+#include "FakeRadio.hpp"
+#include "LoRaCom.hpp"
+#include "Sx126xRadio.hpp"
+
+// LoRaCom on one radio backend. Radio is a policy class with the members of
+// FakeRadio / Sx126xRadio; SIMULATED selects the fake receive path at compile
+// time. The backends built into the firmware are instantiated at the end of
+// LoRaComT.cpp, a new one needs a line there.
+template <typename Radio>
+class LoRaComT final : public LoRaCom {
+ public:
+  ~LoRaComT() override { stopRadioTask(); }  // Before the radio goes away
+
+  bool begin(uint8_t CLK, uint8_t MISO, uint8_t MOSI, uint8_t csPin,
+             uint8_t intPin, uint8_t RST, float freqMHz, int8_t power,
+             int8_t BUSY = -1);
+
+  bool isSimulated() const override { return Radio::SIMULATED; }
+  int32_t getRssi() override;
+
+  bool setOutGain(int8_t gain) override;
+  bool setFrequency(float freqMHz) override;
+  bool setSpreadingFactor(uint8_t spreadingFactor) override;
+  bool setBandwidth(float bandwidth) override;
+  void setCodingRate(int cr) override;
+  void setSyncWord(uint8_t sw) override;
+
+  void setFakeBusyScans(uint8_t scans) override;
+
+ protected:
+  void radioTask() override;
+  void restartReceive() override;
+  void applyHopPreset(uint8_t index) override;
+
+ private:
+  Radio radio;
+
+  void serviceRadio();
+  void serviceSimulated();
+  void finishTx();
+  bool startNextTx();
+  void readoutRx();
+  int startRx();
+  bool channelBusy();
+  bool lbtAllowsTx();
+  void serviceHopping();
+  void serviceNoiseSampler();
+};
+
+typedef LoRaComT<Sx126xRadio<SX1262>> LoRaComSX1262;
+typedef LoRaComT<FakeRadio> LoRaComFake;
+
+#endif
@@ -0,0 +1,86 @@
+// MeshHeader.hpp
+#ifndef MeshHeader_h
+#define MeshHeader_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Meshtastic over-the-air header:
+// to(4) from(4) id(4) flags(1) channel_hash(1) next_hop(1) relay_node(1)
+#define MESH_HEADER_LEN 16
+#define MESH_BROADCAST_ADDR 0xFFFFFFFF
+
+// Flag byte layout
+#define MESH_FLAGS_HOP_LIMIT_MASK 0x07
+#define MESH_FLAGS_WANT_ACK_MASK 0x08
+#define MESH_FLAGS_VIA_MQTT_MASK 0x10
+#define MESH_FLAGS_HOP_START_MASK 0xE0
+#define MESH_FLAGS_HOP_START_SHIFT 5
+
+// Read-only view over the first 16 bytes of a received packet. Nothing is
+// copied or allocated, every field is decoded on access straight from the
+// slot, so the view is only valid while the packet slot is held.
+class MeshHeaderView {
+ public:
+  constexpr MeshHeaderView(const uint8_t *data, size_t length)
+      : m_data(length >= MESH_HEADER_LEN ? data : nullptr) {}
+
+  // False for packets too short to carry a Meshtastic header
+  constexpr bool valid() const { return m_data != nullptr; }
+
+  constexpr uint32_t to() const { return le32(0); }
+  constexpr uint32_t from() const { return le32(4); }
+  constexpr uint32_t id() const { return le32(8); }
+  constexpr uint8_t flags() const { return m_data[12]; }
+  constexpr uint8_t channelHash() const { return m_data[13]; }
+  constexpr uint8_t nextHop() const { return m_data[14]; }
+  constexpr uint8_t relayNode() const { return m_data[15]; }
+
+  constexpr uint8_t hopLimit() const { return flags() & MESH_FLAGS_HOP_LIMIT_MASK; }
+  constexpr bool wantAck() const { return (flags() & MESH_FLAGS_WANT_ACK_MASK) != 0; }
+  constexpr bool viaMqtt() const { return (flags() & MESH_FLAGS_VIA_MQTT_MASK) != 0; }
+  constexpr uint8_t hopStart() const {
+    return (flags() & MESH_FLAGS_HOP_START_MASK) >> MESH_FLAGS_HOP_START_SHIFT;
+  }
+  // Hops already travelled, 0 when the sender does not fill hop_start
+  constexpr uint8_t hopsAway() const {
+    return hopStart() >= hopLimit() ? hopStart() - hopLimit() : 0;
+  }
+  constexpr bool isBroadcast() const { return to() == MESH_BROADCAST_ADDR; }
+
+  // Encrypted payload follows the header
+  constexpr const uint8_t *payload() const { return m_data + MESH_HEADER_LEN; }
+
+ private:
+  const uint8_t *m_data;
+
+  constexpr uint32_t le32(size_t offset) const {
+    return (uint32_t)m_data[offset] | ((uint32_t)m_data[offset + 1] << 8) |
+           ((uint32_t)m_data[offset + 2] << 16) | ((uint32_t)m_data[offset + 3] << 24);
+  }
+};
+
+// Compile-time checks of the decoding against a known header:
+// broadcast from !a1b2c3d4, id 0x11223344, hop_start 3, hop_limit 2, want_ack
+namespace mesh_header_check {
+constexpr uint8_t kSample[MESH_HEADER_LEN] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xD4, 0xC3, 0xB2, 0xA1,
+    0x44, 0x33, 0x22, 0x11, 0x6A, 0x08, 0x00, 0xD4};
+constexpr MeshHeaderView kView(kSample, sizeof(kSample));
+
+static_assert(kView.valid(), "16 bytes must be a valid header");
+static_assert(!MeshHeaderView(kSample, MESH_HEADER_LEN - 1).valid(), "short packet must be rejected");
+static_assert(kView.isBroadcast(), "to");
+static_assert(kView.from() == 0xA1B2C3D4, "from is little-endian");
+static_assert(kView.id() == 0x11223344, "id is little-endian");
+static_assert(kView.hopLimit() == 2, "hop_limit is bits 0-2");
+static_assert(kView.wantAck(), "want_ack is bit 3");
+static_assert(!kView.viaMqtt(), "via_mqtt is bit 4");
+static_assert(kView.hopStart() == 3, "hop_start is bits 5-7");
+static_assert(kView.hopsAway() == 1, "hops away");
+static_assert(kView.channelHash() == 0x08, "channel_hash");
+static_assert(kView.nextHop() == 0x00, "next_hop");
+static_assert(kView.relayNode() == 0xD4, "relay_node");
+}  // namespace mesh_header_check
+
+#endif
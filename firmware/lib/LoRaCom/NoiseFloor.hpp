@@ -0,0 +1,72 @@
+// NoiseFloor.hpp
+#ifndef NoiseFloor_h
+#define NoiseFloor_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "../lora_config.hpp"
+
+// Sample value for "a LoRa packet was in flight, RSSI not taken"
+#define NOISE_IN_FLIGHT INT8_MAX
+
+// Last NOISE_WINDOW_SAMPLES instantaneous RSSI readings, whole dBm. The
+// noise floor is a low percentile of the readings, so bursts of traffic or
+// interference do not pull it up; a reading counts as busy when it is more
+// than NOISE_BUSY_MARGIN_DB above that floor. Not thread safe, the owner
+// serialises access.
+class NoiseWindow {
+ public:
+  void addSample(float rssiDbm) {
+    int value = (int)(rssiDbm < 0 ? rssiDbm - 0.5f : rssiDbm + 0.5f);
+    if (value < INT8_MIN) value = INT8_MIN;
+    if (value >= NOISE_IN_FLIGHT) value = NOISE_IN_FLIGHT - 1;
+    push((int8_t)value);
+  }
+  void addInFlight() { push(NOISE_IN_FLIGHT); }
+  void clear() { m_count = 0; }
+
+  size_t size() const { return m_count; }
+
+  // floorDbm is 0 while there are no energy readings yet. busyPercent counts
+  // energy above the floor, loraPercent the samples skipped for a packet.
+  void summarise(float &floorDbm, float &busyPercent, float &loraPercent) const {
+    int8_t energy[NOISE_WINDOW_SAMPLES];
+    size_t energyCount = 0;
+    size_t inFlight = 0;
+    for (size_t i = 0; i < m_count; i++) {
+      if (m_samples[i] == NOISE_IN_FLIGHT) inFlight++;
+      else energy[energyCount++] = m_samples[i];
+    }
+
+    floorDbm = 0;
+    busyPercent = 0;
+    loraPercent = m_count ? (100.0f * inFlight) / m_count : 0;
+    if (energyCount == 0) return;
+
+    size_t rank = (energyCount * NOISE_FLOOR_PERCENTILE) / 100;
+    std::nth_element(energy, energy + rank, energy + energyCount);
+    floorDbm = energy[rank];
+
+    size_t busy = 0;
+    for (size_t i = 0; i < energyCount; i++) {
+      if (energy[i] > floorDbm + NOISE_BUSY_MARGIN_DB) busy++;
+    }
+    busyPercent = (100.0f * busy) / m_count;
+  }
+
+ private:
+  int8_t m_samples[NOISE_WINDOW_SAMPLES];
+  size_t m_count = 0;
+  size_t m_next = 0;
+
+  void push(int8_t value) {
+    m_samples[m_next] = value;
+    m_next = (m_next + 1) % NOISE_WINDOW_SAMPLES;
+    if (m_count < NOISE_WINDOW_SAMPLES) m_count++;
+  }
+};
+
+#endif
@@ -0,0 +1,126 @@
+// PacketRing.hpp
+#ifndef PacketRing_h
+#define PacketRing_h
+
+#include <Arduino.h>
+
+#include <atomic>
+
+// Largest SX1262 packet plus room for a terminating '\0'
+#define LORA_PACKET_SLOT_SIZE 256
+
+// Radio state captured for one packet when it is read out of the FIFO.
+// Travels with the packet so batched uploads report the right values.
+struct RxMetadata {
+  int64_t timestampUs = 0;  // esp_timer time of the RX done interrupt
+  float rssi = 0;           // dBm
+  float snr = 0;            // dB
+  float freqErrorHz = 0;
+  float bw = 0;             // kHz
+  float freqMHz = 0;        // Receive frequency
+  uint16_t length = 0;      // Bytes received over the air, header included
+  uint8_t sf = 0;
+  uint8_t cr = 0;
+  bool crcOk = false;
+  int8_t preset = -1;       // Receive hopping preset index, -1 when not hopping
+};
+
+// One preallocated packet buffer. The radio reads straight into data[],
+// nothing is copied again until the packet is released.
+struct PacketSlot {
+  uint8_t data[LORA_PACKET_SLOT_SIZE];
+  size_t headerOffset;    // Where the payload starts inside data[]
+  RxMetadata meta;
+};
+
+// View of a queued packet, valid until the slot is released
+struct PacketView {
+  const uint8_t *data = nullptr;
+  uint8_t *slotData = nullptr;  // Same bytes, for consumers that rewrite the payload in place (decryption)
+  size_t length = 0;
+  size_t headerOffset = 0;
+  RxMetadata meta;
+
+  const uint8_t *payload() const { return data + headerOffset; }
+  size_t payloadLength() const { return length > headerOffset ? length - headerOffset : 0; }
+};
+
+// Lock-free single-producer / single-consumer ring of received packets.
+// The radio task is the only producer (moves head), the LoRa data task is the
+// only consumer (moves tail), so no locking is needed between them.
+//
+// Producer: acquire() a slot, fill it, commit(). Consumer: peek() a view,
+// process it in place, release().
+template <size_t Capacity>
+class PacketRing {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "PacketRing capacity must be a power of two");
+
+ public:
+  // Producer side. Returns nullptr (and counts a drop) when the ring is full.
+  PacketSlot *acquire() {
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    uint32_t tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail >= Capacity) {
+      m_dropped++;
+      return nullptr;
+    }
+    return &m_slots[head & (Capacity - 1)];
+  }
+
+  // Publishes the slot returned by the last acquire()
+  void commit(const RxMetadata &meta, size_t headerOffset) {
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    PacketSlot &slot = m_slots[head & (Capacity - 1)];
+    slot.meta = meta;
+    if (slot.meta.length > LORA_PACKET_SLOT_SIZE - 1) slot.meta.length = LORA_PACKET_SLOT_SIZE - 1;
+    if (headerOffset > slot.meta.length) headerOffset = slot.meta.length;
+    slot.data[slot.meta.length] = '\0';  // Text handlers can use the payload as a C string
+    slot.headerOffset = headerOffset;
+    m_head.store(head + 1, std::memory_order_release);
+
+    uint32_t used = head + 1 - m_tail.load(std::memory_order_acquire);
+    if (used > m_highWater) m_highWater = used;
+  }
+
+  // Consumer side. Returns a view of the oldest packet without copying it.
+  // The consumer owns the slot until release(), so it may modify data[].
+  bool peek(PacketView &view) {
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    uint32_t head = m_head.load(std::memory_order_acquire);
+    if (head == tail) return false;
+
+    PacketSlot &slot = m_slots[tail & (Capacity - 1)];
+    view.data = slot.data;
+    view.slotData = slot.data;
+    view.length = slot.meta.length;
+    view.headerOffset = slot.headerOffset;
+    view.meta = slot.meta;
+    return true;
+  }
+
+  // Hands the oldest slot back to the producer
+  void release() {
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire)) return;
+    m_tail.store(tail + 1, std::memory_order_release);
+  }
+
+  size_t size() const {
+    return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+  }
+  static constexpr size_t capacity() { return Capacity; }
+  uint32_t getDropped() const { return m_dropped; }
+  uint32_t getHighWater() const { return m_highWater; }
+
+ private:
+  PacketSlot m_slots[Capacity];
+  std::atomic<uint32_t> m_head{0};
+  std::atomic<uint32_t> m_tail{0};
+
+  // Written by the producer only
+  volatile uint32_t m_dropped = 0;
+  volatile uint32_t m_highWater = 0;
+};
+
+#endif
@@ -0,0 +1,66 @@
+// PingFrame.hpp
+#ifndef PingFrame_h
+#define PingFrame_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Round-trip probe exchanged between two nodes in ping mode. The echo is
+// the probe sent back with the type changed, so the initiator gets its own
+// transmit timestamp back and needs no per-probe state to compute the RTT.
+//
+//   0..2  "PNG" magic
+//   3     type: PING_TYPE_PROBE or PING_TYPE_ECHO
+//   4..5  sequence number, little endian
+//   6..9  initiator esp_timer time at TX start (low 32 bits, us), little endian
+#define PING_FRAME_LEN 10
+#define PING_TYPE_PROBE 0x01
+#define PING_TYPE_ECHO 0x02
+
+class PingFrame {
+ public:
+  constexpr PingFrame(const uint8_t *data, size_t length) : m_data(data), m_length(length) {}
+
+  constexpr bool valid() const {
+    return m_length >= PING_FRAME_LEN && m_data[0] == 'P' && m_data[1] == 'N' && m_data[2] == 'G' &&
+           (m_data[3] == PING_TYPE_PROBE || m_data[3] == PING_TYPE_ECHO);
+  }
+  constexpr bool isProbe() const { return valid() && m_data[3] == PING_TYPE_PROBE; }
+  constexpr bool isEcho() const { return valid() && m_data[3] == PING_TYPE_ECHO; }
+  constexpr uint16_t seq() const { return (uint16_t)(m_data[4] | (m_data[5] << 8)); }
+  constexpr uint32_t txTimeUs() const {
+    return (uint32_t)m_data[6] | ((uint32_t)m_data[7] << 8) | ((uint32_t)m_data[8] << 16) |
+           ((uint32_t)m_data[9] << 24);
+  }
+
+  static void build(uint8_t *out, uint8_t type, uint16_t seq, uint32_t txTimeUs) {
+    out[0] = 'P';
+    out[1] = 'N';
+    out[2] = 'G';
+    out[3] = type;
+    out[4] = seq & 0xFF;
+    out[5] = seq >> 8;
+    setTxTime(out, txTimeUs);
+  }
+  static void setTxTime(uint8_t *out, uint32_t txTimeUs) {
+    out[6] = txTimeUs & 0xFF;
+    out[7] = (txTimeUs >> 8) & 0xFF;
+    out[8] = (txTimeUs >> 16) & 0xFF;
+    out[9] = txTimeUs >> 24;
+  }
+
+ private:
+  const uint8_t *m_data;
+  size_t m_length;
+};
+
+namespace ping_frame_check {
+constexpr uint8_t kProbe[PING_FRAME_LEN] = {'P', 'N', 'G', PING_TYPE_PROBE, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12};
+static_assert(PingFrame(kProbe, sizeof(kProbe)).isProbe(), "probe recognised");
+static_assert(!PingFrame(kProbe, sizeof(kProbe)).isEcho(), "probe is not an echo");
+static_assert(PingFrame(kProbe, sizeof(kProbe)).seq() == 0x1234, "sequence is little endian");
+static_assert(PingFrame(kProbe, sizeof(kProbe)).txTimeUs() == 0x12345678, "timestamp is little endian");
+static_assert(!PingFrame(kProbe, PING_FRAME_LEN - 1).valid(), "short frame rejected");
+}  // namespace ping_frame_check
+
+#endif
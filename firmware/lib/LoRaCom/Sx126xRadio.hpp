@@ -0,0 +1,99 @@
+// Sx126xRadio.hpp
+#ifndef Sx126xRadio_h
+#define Sx126xRadio_h
+
+#include <Arduino.h>
+#include <RadioLib.h>
+
+#include "../lora_config.hpp"
+
+// Meshtastic-style duty cycle parameters
+#define MESHTASTIC_PREAMBLE_LENGTH 20 // было 8 - не правильно.
+#define MESHTASTIC_RADIOLIB_IRQ_RX_FLAGS ((1UL << RADIOLIB_IRQ_RX_DONE) | (1UL << RADIOLIB_IRQ_PREAMBLE_DETECTED) | (1UL << RADIOLIB_IRQ_HEADER_VALID))
+// Receive hopping and the noise sampler: latch preamble/header IRQs too, so a packet in flight can be seen before RX_DONE
+#define LATCHED_RADIOLIB_IRQ_RX_FLAGS (RADIOLIB_IRQ_RX_DEFAULT_FLAGS | (1UL << RADIOLIB_IRQ_PREAMBLE_DETECTED))
+
+// Radio policy over a RadioLib SX126x chip class (SX1262, SX1268). An
+// LR11xx or SX127x backend is another adapter with the same members.
+template <typename Chip>
+class Sx126xRadio {
+ public:
+  static constexpr bool SIMULATED = false;
+
+  ~Sx126xRadio() {
+    if (chip && irqAttached) chip->clearPacketReceivedAction();
+    delete chip;
+    delete module;
+  }
+
+  int begin(uint8_t CLK, uint8_t MISO, uint8_t MOSI, uint8_t csPin, uint8_t intPin, uint8_t RST,
+            float freqMHz, int8_t power, int8_t BUSY) {
+    SPI.begin(CLK, MISO, MOSI, csPin);
+    module = (BUSY == -1) ? new Module(csPin, intPin, RST) : new Module(csPin, intPin, RST, BUSY);
+    chip = new Chip(module);
+
+#if defined(SX126X_DIO3_TCXO_VOLTAGE)
+    // SX1262::begin(freq, bw, sf, cr, syncWord, power, preambleLength, tcxoVoltage)
+    // freq: 868.06 MHz, bw: 125 kHz, sf: 11, cr: 4/5, syncWord: 0x12, power: 22 dBm, preamble: 20, tcxo: 1.8V
+    int state = chip->begin(freqMHz, 250.0, 11, 5, 0x12, power, 20, SX126X_DIO3_TCXO_VOLTAGE);
+#else
+    // SX1262::begin(freq, bw, sf, cr, syncWord, power, preambleLength)
+    // freq: 868.075 MHz, bw: 250 kHz, sf: 11, cr: 4/5, syncWord: 0x12, power: 20 dBm, preamble: 20
+    int state = chip->begin(freqMHz, 250.0, 11, 5, 0x12, power, 20);
+#endif
+
+#if defined(SX126X_DIO2_AS_RF_SWITCH)
+    // Set DIO2 as RF switch for antenna multiplexing
+    state |= chip->setDio2AsRfSwitch(true);
+#endif
+    return state;
+  }
+
+  void setIrqAction(void (*func)(void)) {
+    chip->setPacketReceivedAction(func);
+    irqAttached = true;
+  }
+
+  int startReceive(bool latchPreamble) {
+    if (latchPreamble) {
+      return chip->startReceive(RADIOLIB_SX126X_RX_TIMEOUT_INF, LATCHED_RADIOLIB_IRQ_RX_FLAGS,
+                                RADIOLIB_IRQ_RX_DEFAULT_MASK);
+    }
+    return chip->startReceive();
+  }
+  int startReceiveDutyCycle() {
+    return chip->startReceiveDutyCycleAuto(MESHTASTIC_PREAMBLE_LENGTH, 8, MESHTASTIC_RADIOLIB_IRQ_RX_FLAGS);
+  }
+  // Preamble or header latched: a packet is arriving but RX_DONE has not fired yet
+  bool packetInFlight() {
+    return chip->checkIrq(RADIOLIB_IRQ_PREAMBLE_DETECTED) || chip->checkIrq(RADIOLIB_IRQ_HEADER_VALID);
+  }
+  size_t packetLength() { return chip->getPacketLength(); }
+  int readData(uint8_t *buffer, size_t len) { return chip->readData(buffer, len); }
+  float packetRssi() { return chip->getRSSI(); }
+  float packetSnr() { return chip->getSNR(); }
+  float frequencyError() { return chip->getFrequencyError(); }
+  // RSSI_INST is read while the receiver keeps running, no RX window is lost
+  float channelRssi() { return chip->getRSSI(false); }
+
+  int startTransmit(const uint8_t *data, size_t len) { return chip->startTransmit(data, len); }
+  int finishTransmit() { return chip->finishTransmit(); }
+  int standby() { return chip->standby(); }
+
+  int setOutputPower(int8_t power) { return chip->setOutputPower(power); }
+  int setFrequency(float freq) { return chip->setFrequency(freq); }
+  int setSpreadingFactor(uint8_t sf) { return chip->setSpreadingFactor(sf); }
+  int setBandwidth(float bw) { return chip->setBandwidth(bw); }
+  int setCodingRate(uint8_t cr) { return chip->setCodingRate(cr); }
+  int setSyncWord(uint8_t syncWord) { return chip->setSyncWord(syncWord); }
+
+  // scanChannel() blocks for a few symbols and polls DIO1 itself
+  bool channelBusy() { return chip->scanChannel() == RADIOLIB_LORA_DETECTED; }
+
+ private:
+  Module *module = nullptr;
+  Chip *chip = nullptr;
+  bool irqAttached = false;
+};
+
+#endif
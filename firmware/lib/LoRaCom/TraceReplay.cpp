@@ -0,0 +1,115 @@
+// TraceReplay.cpp
+#include "TraceReplay.hpp"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+
+static int hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool TraceReplay::parseLine(const char *line, TraceRecord &record) {
+  while (isspace((unsigned char)*line)) line++;
+  if (*line == '\0' || *line == '#') return false;
+
+  char *end;
+  record.deltaMs = strtoul(line, &end, 10);
+  if (end == line) return false;
+  line = end;
+  record.rssi = strtof(line, &end);
+  if (end == line) return false;
+  line = end;
+  record.snr = strtof(line, &end);
+  if (end == line) return false;
+  line = end;
+  while (isspace((unsigned char)*line)) line++;
+
+  size_t length = 0;
+  while (hexNibble(line[0]) >= 0 && hexNibble(line[1]) >= 0) {
+    if (length >= sizeof(record.data)) return false;
+    record.data[length++] = (hexNibble(line[0]) << 4) | hexNibble(line[1]);
+    line += 2;
+  }
+  // Trailing garbage or an odd digit means the line was cut or mangled
+  while (isspace((unsigned char)*line)) line++;
+  if (length == 0 || *line != '\0') return false;
+  record.length = length;
+  return true;
+}
+
+bool TraceReplay::open(const char *path, float speed, bool loop, int64_t nowUs) {
+  close();
+  m_file = fopen(path, "r");
+  if (!m_file) {
+    ESP_LOGE(TAG, "Cannot open trace %s", path);
+    return false;
+  }
+  m_speed = speed < 0 ? 0 : speed;
+  m_loop = loop;
+  m_played = 0;
+  m_badLines = 0;
+  m_loops = 0;
+  if (!readNext(nowUs)) {
+    ESP_LOGE(TAG, "Trace %s has no records", path);
+    close();
+    return false;
+  }
+  ESP_LOGI(TAG, "Replaying %s at %.1fx%s", path, m_speed, m_loop ? ", looped" : "");
+  return true;
+}
+
+void TraceReplay::close() {
+  if (m_file) {
+    fclose(m_file);
+    m_file = nullptr;
+    ESP_LOGI(TAG, "Replay finished: %lu packets, %lu bad lines, %lu loops", (unsigned long)m_played,
+             (unsigned long)m_badLines, (unsigned long)m_loops);
+  }
+  m_hasPending = false;
+}
+
+bool TraceReplay::readNext(int64_t fromUs) {
+  // Long enough for a full packet in hex plus the three numbers
+  char line[2 * sizeof(TraceRecord::data) + 64];
+  bool rewound = false;
+  while (true) {
+    if (!fgets(line, sizeof(line), m_file)) {
+      // A looped trace with no valid record at all must not spin forever
+      if (!m_loop || rewound) return false;
+      rewind(m_file);
+      rewound = true;
+      m_loops++;
+      continue;
+    }
+    if (parseLine(line, m_pending)) break;
+    const char *p = line;
+    while (isspace((unsigned char)*p)) p++;
+    if (*p != '\0' && *p != '#') m_badLines++;
+  }
+  m_hasPending = true;
+  m_dueUs = fromUs + (m_speed > 0 ? (int64_t)(m_pending.deltaMs * 1000.0f / m_speed) : 0);
+  return true;
+}
+
+const TraceRecord *TraceReplay::peek(int64_t nowUs) {
+  if (!m_hasPending || nowUs < m_dueUs) return nullptr;
+  return &m_pending;
+}
+
+void TraceReplay::pop() {
+  if (!m_hasPending) return;
+  m_played++;
+  // Deltas chain from the due time, so a late wakeup does not stretch the trace
+  if (!readNext(m_dueUs)) close();
+}
+
+int64_t TraceReplay::untilDueUs(int64_t nowUs) const {
+  if (!m_hasPending || nowUs >= m_dueUs) return 0;
+  return m_dueUs - nowUs;
+}
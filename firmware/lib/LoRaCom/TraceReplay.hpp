@@ -0,0 +1,66 @@
+// TraceReplay.hpp
+#ifndef TraceReplay_h
+#define TraceReplay_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../lora_config.hpp"
+
+// One captured reception
+struct TraceRecord {
+  uint32_t deltaMs = 0;  // Time since the previous record
+  float rssi = 0;
+  float snr = 0;
+  uint16_t length = 0;
+  uint8_t data[255];     // SX1262 FIFO limit
+};
+
+// Plays a packet trace back in fake mode. The trace is a text file, one
+// record per line, '#' starts a comment:
+//
+//   <delta_ms> <rssi_dbm> <snr_db> <packet bytes as hex>
+//   250 -97.5 6.25 ffffffff4c8a3b9e...
+//
+// Records become due delta_ms / speed after the previous one; speed 0 plays
+// as fast as the consumer takes packets. Uses stdio, so on the ESP32 the
+// path is a VFS path such as /littlefs/trace.txt.
+class TraceReplay {
+ public:
+  ~TraceReplay() { close(); }
+
+  bool open(const char *path, float speed, bool loop, int64_t nowUs);
+  void close();
+  bool isActive() const { return m_file != nullptr; }
+
+  // The next record once it is due, stays pending until pop()
+  const TraceRecord *peek(int64_t nowUs);
+  void pop();
+  // Time until the pending record is due, 0 when it already is
+  int64_t untilDueUs(int64_t nowUs) const;
+
+  float speed() const { return m_speed; }
+  uint32_t getPlayed() const { return m_played; }
+  uint32_t getBadLines() const { return m_badLines; }
+  uint32_t getLoops() const { return m_loops; }
+
+  // Parses one trace line, false for comments, blank and malformed lines
+  static bool parseLine(const char *line, TraceRecord &record);
+
+ private:
+  static constexpr const char *TAG = "TraceReplay";
+
+  FILE *m_file = nullptr;
+  float m_speed = 1.0f;
+  bool m_loop = false;
+  TraceRecord m_pending;
+  bool m_hasPending = false;
+  int64_t m_dueUs = 0;
+  uint32_t m_played = 0;
+  uint32_t m_badLines = 0;
+  uint32_t m_loops = 0;
+
+  bool readNext(int64_t fromUs);
+};
+
+#endif
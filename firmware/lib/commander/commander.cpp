@@ -132,8 +132,144 @@ void Commander::handle_set_OUTPUT() {
 #endif
 
 void Commander::handle_mode() {
-  // Implementation for mode command
-  ESP_LOGD(TAG, "Mode command not implemented yet");
+  ESP_LOGD(TAG, "Mode command executed");
+  checkCommand(mode_handler);  // Check and run the mode command
+}
+
+void Commander::handle_mode_help() {
+  handle_help(mode_handler);  // Call the generic help handler
+}
+
+// ----- Survey Handlers Implementation -----
+void Commander::handle_mode_survey() {
+  if (!m_control || !m_control->getSurvey()) {
+    ESP_LOGW(TAG, "Survey not available");
+    return;
+  }
+  checkCommand(survey_handler);  // start, stop, status, report, ...
+}
+
+void Commander::handle_survey_help() {
+  handle_help(survey_handler);  // Call the generic help handler
+}
+
+void Commander::handle_survey_start() {
+  m_control->getSurvey()->start();
+}
+
+void Commander::handle_survey_stop() {
+  m_control->getSurvey()->stop();
+}
+
+void Commander::handle_survey_status() {
+  m_control->getSurvey()->printStatus();
+}
+
+void Commander::handle_survey_report() {
+  m_control->getSurvey()->printSummary();
+}
+
+void Commander::handle_survey_clear() {
+  m_control->getSurvey()->clearPresets();
+}
+
+void Commander::handle_survey_add() {
+  char* freq = readAndRemove();
+  char* sf = readAndRemove();
+  char* bw = readAndRemove();
+  char* cr = readAndRemove();
+  char* sync = readAndRemove();
+  if (sync == nullptr) {
+    ESP_LOGW(TAG, "Expecting <freqMHz> <sf> <bwKHz> <cr> <sync word>");
+    return;
+  }
+  SurveyPreset preset = {static_cast<float>(atof(freq)), static_cast<uint8_t>(atoi(sf)),
+                         static_cast<float>(atof(bw)), static_cast<uint8_t>(atoi(cr)),
+                         static_cast<uint8_t>(strtol(sync, nullptr, 0))};  // Sync word may be given as 0x2B
+  m_control->getSurvey()->addPreset(preset);
+}
+
+void Commander::handle_survey_dwell() {
+  char* data = readAndRemove();
+  if (data == nullptr) {
+    ESP_LOGW(TAG, "Expecting <seconds>");
+    return;
+  }
+  m_control->getSurvey()->setDwellMs(atoi(data) * 1000UL);
+}
+
+// ----- Ping Handlers Implementation -----
+void Commander::handle_mode_ping() {
+  if (!m_control || !m_control->getPing()) {
+    ESP_LOGW(TAG, "Ping not available");
+    return;
+  }
+  checkCommand(ping_handler);  // start, stop, status, report, echo
+}
+
+void Commander::handle_ping_help() {
+  handle_help(ping_handler);  // Call the generic help handler
+}
+
+void Commander::handle_ping_start() {
+  char* count = readAndRemove();
+  char* interval = readAndRemove();
+  m_control->getPing()->start(count ? strtoul(count, nullptr, 10) : PING_DEFAULT_COUNT,
+                              interval ? strtoul(interval, nullptr, 10) : PING_PROBE_INTERVAL_MS);
+}
+
+void Commander::handle_ping_stop() {
+  m_control->getPing()->stop();
+}
+
+void Commander::handle_ping_status() {
+  m_control->getPing()->printStatus();
+}
+
+void Commander::handle_ping_report() {
+  m_control->getPing()->printSummary();
+}
+
+void Commander::handle_ping_echo() {
+  char* data = readAndRemove();
+  if (data == nullptr) {
+    ESP_LOGW(TAG, "Expecting <0|1>");
+    return;
+  }
+  m_loraCom->setPingEchoEnabled(atoi(data) == 1);
+  ESP_LOGI(TAG, "Ping echo %s", m_loraCom->isPingEchoEnabled() ? "ON" : "OFF");
+}
+
+// ----- Replay Handlers Implementation -----
+void Commander::handle_mode_replay() {
+  checkCommand(replay_handler);  // start, stop, status
+}
+
+void Commander::handle_replay_help() {
+  handle_help(replay_handler);  // Call the generic help handler
+}
+
+void Commander::handle_replay_start() {
+  char* path = readAndRemove();
+  char* speed = readAndRemove();
+  char* loop = readAndRemove();
+  if (path == nullptr) {
+    ESP_LOGW(TAG, "Expecting <path> [speed] [loop 0|1], e.g. /littlefs/trace.txt 10 1");
+    return;
+  }
+  m_loraCom->startReplay(path, speed ? atof(speed) : 1.0f, loop && atoi(loop) == 1);
+}
+
+void Commander::handle_replay_stop() {
+  m_loraCom->stopReplay();
+}
+
+void Commander::handle_replay_status() {
+  char buf[128];
+  sprintf(buf, "replay active=%d played=%lu bad_lines=%lu loops=%lu ring_dropped=%lu\n", m_loraCom->isReplaying(),
+          (unsigned long)m_loraCom->getReplayPlayed(), (unsigned long)m_loraCom->getReplayBadLines(),
+          (unsigned long)m_loraCom->getReplayLoops(), (unsigned long)m_loraCom->getRxRingDropped());
+  m_serialCom->sendData(buf);
 }
 
 // ----- Get Handlers Implementation -----
@@ -397,6 +533,40 @@ const Commander::HandlerMap Commander::set_handler[4] = {
     {"wifi_credentials", &Commander::handle_set_wifi_credentials},
     {nullptr, nullptr}};
 
+const Commander::HandlerMap Commander::mode_handler[5] = {
+    {"help", &Commander::handle_mode_help},
+    {"survey", &Commander::handle_mode_survey},
+    {"ping", &Commander::handle_mode_ping},
+    {"replay", &Commander::handle_mode_replay},
+    {nullptr, nullptr}};
+
+const Commander::HandlerMap Commander::survey_handler[9] = {
+    {"help", &Commander::handle_survey_help},
+    {"start", &Commander::handle_survey_start},
+    {"stop", &Commander::handle_survey_stop},
+    {"status", &Commander::handle_survey_status},
+    {"report", &Commander::handle_survey_report},
+    {"clear", &Commander::handle_survey_clear},
+    {"add", &Commander::handle_survey_add},
+    {"dwell", &Commander::handle_survey_dwell},
+    {nullptr, nullptr}};
+
+const Commander::HandlerMap Commander::ping_handler[7] = {
+    {"help", &Commander::handle_ping_help},
+    {"start", &Commander::handle_ping_start},
+    {"stop", &Commander::handle_ping_stop},
+    {"status", &Commander::handle_ping_status},
+    {"report", &Commander::handle_ping_report},
+    {"echo", &Commander::handle_ping_echo},
+    {nullptr, nullptr}};
+
+const Commander::HandlerMap Commander::replay_handler[5] = {
+    {"help", &Commander::handle_replay_help},
+    {"start", &Commander::handle_replay_start},
+    {"stop", &Commander::handle_replay_stop},
+    {"status", &Commander::handle_replay_status},
+    {nullptr, nullptr}};
+
 const Commander::HandlerMap Commander::get_handler[15] = {
     {"help", &Commander::handle_get_help},
     {"gain", &Commander::handle_get_gain},
@@ -50,6 +50,30 @@ class Commander {
   void handle_set_help();
   void handle_set_OUTPUT();
 
+  // ----- Mode Handlers -----
+  void handle_mode_help();
+  void handle_mode_survey();    // Command handler for "mode survey <action>"
+  void handle_survey_help();
+  void handle_survey_start();
+  void handle_survey_stop();
+  void handle_survey_status();
+  void handle_survey_report();
+  void handle_survey_clear();
+  void handle_survey_add();     // "mode survey add <freqMHz> <sf> <bwKHz> <cr> <sync>"
+  void handle_survey_dwell();   // "mode survey dwell <seconds>"
+  void handle_mode_ping();      // Command handler for "mode ping <action>"
+  void handle_ping_help();
+  void handle_ping_start();     // "mode ping start [count] [interval_ms]"
+  void handle_ping_stop();
+  void handle_ping_status();
+  void handle_ping_report();
+  void handle_ping_echo();      // "mode ping echo <0|1>", answer probes from a peer
+  void handle_mode_replay();    // Command handler for "mode replay <action>" (fake mode)
+  void handle_replay_help();
+  void handle_replay_start();   // "mode replay start <path> [speed] [loop 0|1]"
+  void handle_replay_stop();
+  void handle_replay_status();
+
   // ----- Get Handlers -----
   void handle_get_help();
   void handle_get_gain();
@@ -75,6 +99,10 @@ class Commander {
   static const HandlerMap update_handler[6];
   static const HandlerMap set_handler[4];
   static const HandlerMap get_handler[15];
+  static const HandlerMap mode_handler[5];
+  static const HandlerMap survey_handler[9];
+  static const HandlerMap ping_handler[7];
+  static const HandlerMap replay_handler[5];
 
   void runMappedCommand(char *command, const HandlerMap *handler);
 
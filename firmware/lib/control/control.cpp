@@ -1,4 +1,7 @@
 #include "control.hpp"
+
+#include "Base64.hpp"
+#include "Crc32.hpp"
 #include "commander.hpp"
 
 void* wifi_manager_global = nullptr;
@@ -20,13 +23,24 @@ int fake_rssi_counter = 0;  // Start from 0 dBm (will increment to INT_MAX)
 
 Control::Control() {
   m_serialCom = new SerialCom();  // Initialize SerialCom instance
-  m_LoRaCom = new LoRaCom();      // Initialize LoRaCom instance
-  m_commander =
-      new Commander(m_serialCom, m_LoRaCom, this);  // Initialize Commander instance
+  // LoRaCom and everything using it are created in setup(), once the radio backend is known
+  m_LoRaCom = nullptr;
+  m_survey = nullptr;
+  m_ping = nullptr;
+  m_commander = nullptr;
+
+  // MAC bytes 4 and 5, printed as in the address
+  uint64_t mac = ESP.getEfuseMac();
+  m_txTag = ((mac >> 24) & 0xFF00) | ((mac >> 40) & 0xFF);
 
-  //m_saveFlash = new SaveFlash(m_serialCom);  // Initialize SaveFlash instance
   m_wifiManager = new WiFiManager();         // Initialize WiFiManager instance
   wifi_manager_global = m_wifiManager;       // Set global pointer
+
+  // Default key on the preset's channel, more with "command set channel"
+  if (strlen(MESH_DEFAULT_CHANNEL) > 0) {
+    const uint8_t defaultPsk = 1;
+    m_channelCrypto.setChannel(MESH_DEFAULT_CHANNEL, &defaultPsk, 1);
+  }
 }
 
 void Control::setup() {
@@ -52,22 +66,33 @@ void Control::setup() {
 
   m_serialCom->init(115200);  // Initialize serial communication
 
-  bool loraSuccess = true;
+  // The backend is a template parameter of LoRaComT, the SX1262 one is kept only if the chip answers
+  bool loraSuccess = false;
   if (!FAKE_LORA) {
-    loraSuccess =
-        m_LoRaCom->begin<SX1262>(LORA_SCK, LORA_MISO, LORA_MOSI, LORA_CS,
-                                 LORA_DIO1, LORA_RESET, LORA_FREQUENCY, LORA_POWER, LORA_BUSY);
-    if (!loraSuccess) {
+    LoRaComSX1262 *sx1262 = new LoRaComSX1262();
+    loraSuccess = sx1262->begin(LORA_SCK, LORA_MISO, LORA_MOSI, LORA_CS,
+                                LORA_DIO1, LORA_RESET, LORA_FREQUENCY, LORA_POWER, LORA_BUSY);
+    if (loraSuccess) {
+      m_LoRaCom = sx1262;
+    } else {
+      delete sx1262;
       ESP_LOGW(TAG, "LoRa initialization FAILED! Check your hardware connections.");
       ESP_LOGW(TAG, "***FALLBACK TO FAKE LoRa MODE - HARDWARE NOT DETECTED***");
-      loraSuccess = m_LoRaCom->beginFake(LORA_SCK, LORA_MISO, LORA_MOSI, LORA_CS,
-                                          LORA_DIO1, LORA_RESET, LORA_FREQUENCY, LORA_POWER, LORA_BUSY);
     }
   } else {
     ESP_LOGI(TAG, "FAKE_LORA=1: Skipping hardware LoRa initialization, using fake mode");
-    loraSuccess = m_LoRaCom->beginFake(LORA_SCK, LORA_MISO, LORA_MOSI, LORA_CS,
-                                        LORA_DIO1, LORA_RESET, LORA_FREQUENCY, LORA_POWER, LORA_BUSY);
   }
+  if (m_LoRaCom == nullptr) {
+    LoRaComFake *fake = new LoRaComFake();
+    loraSuccess = fake->begin(LORA_SCK, LORA_MISO, LORA_MOSI, LORA_CS,
+                              LORA_DIO1, LORA_RESET, LORA_FREQUENCY, LORA_POWER, LORA_BUSY);
+    m_LoRaCom = fake;
+  }
+
+  m_survey = new Survey(m_LoRaCom, m_serialCom);  // Initialize Survey instance
+  m_ping = new PingTest(m_LoRaCom, m_serialCom);  // Registers the ping echo handler
+  m_commander =
+      new Commander(m_serialCom, m_LoRaCom, this);  // Initialize Commander instance
 
   if (!loraSuccess) {
     ESP_LOGE(TAG,
@@ -89,6 +114,11 @@ void Control::setup() {
       ESP_LOGI(TAG, "MESH mode enabled, set SF=%d, BW=%d, CR=%d, SW=0x%02X", MESH_SPREADING_FACTOR, MESH_BANDWIDTH, MESH_CODING_RATE, MESH_SYNC_WORD);
     }
 
+    // Hop receive presets instead of staying on the MESH one
+    if (RX_HOP_ENABLED) {
+      m_LoRaCom->startHopping();
+    }
+
     // Log current settings
     if (!FAKE_LORA) {
       int currentSF = m_LoRaCom->getCurrentSF();
@@ -110,9 +140,8 @@ void Control::setup() {
     }
   }
 
-  //m_saveFlash->begin();  // Initialize flash storage
-
-  m_wifiManager->loadSettings();
+  m_wifiManager->loadSettings();  // Mounts LittleFS, formatting it if needed
+  m_captureLog.begin();
 
   // Initialize POST mode based on configuration
   post_on_lora = POST_EN_WHEN_LORA_RECEIVED;
@@ -139,6 +168,7 @@ void Control::begin() {
   }
 
   if (LoRaTaskHandle != nullptr) {
+    m_LoRaCom->setRxNotifyTask(nullptr);
     vTaskDelete(LoRaTaskHandle);
   }
 
@@ -155,6 +185,8 @@ void Control::begin() {
   xTaskCreate(
       [](void *param) { static_cast<Control *>(param)->loRaDataTask(); },
       "LoRaDataTask", 8192, this, 2, &LoRaTaskHandle);
+  m_LoRaCom->setRxNotifyTask(LoRaTaskHandle);  // Radio task wakes the LoRa task per packet
+  m_LoRaCom->startRadioTask();  // Services DIO1, reads the FIFO into the RX ring
 
   xTaskCreate([](void *param) { static_cast<Control *>(param)->statusTask(); },
               "StatusTask", 8192, this, 1, &StatusTaskHandle);
@@ -183,17 +215,116 @@ void Control::serialDataTask() {
   }
 }
 
+// ChannelCrypto check: only the right key gives a well-formed meshtastic_Data
+static bool decodeMeshData(const uint8_t *data, size_t length, void *info) {
+  return MeshDataReader::decode(data, length, *static_cast<MeshDataInfo *>(info));
+}
+
 void Control::loRaDataTask() {
-  char buffer[256];  // Buffer to store incoming data, increased to handle large Meshtastic packets
+  PacketView packet;  // Points into the RX ring slot, nothing is copied out
 
   while (true) {
-    // Always call getMessage to process any pending transmissions/receptions
-    int receivedLen = 0;  // Initialize to track actual received length
-    if (m_LoRaCom->getMessage(buffer, sizeof(buffer), &receivedLen)) {
-      ESP_LOGI(TAG, "LoRa packet received, length: %d bytes", receivedLen);
+    // Drain every packet the radio task has queued since the last wakeup
+    while (m_LoRaCom->peekPacket(packet)) {
+      // Payload is '\0'-terminated inside the slot, so it can be used as text
+      const char *buffer = reinterpret_cast<const char *>(packet.payload());
+      int receivedLen = packet.payloadLength();
+      const RxMetadata &meta = packet.meta;
+      ESP_LOGI(TAG, "LoRa packet received, length: %d bytes, RSSI %.1f dBm, SNR %.1f dB, SF%d BW%.0f CR%d",
+               receivedLen, meta.rssi, meta.snr, meta.sf, meta.bw, meta.cr);
+
+      m_arrivalStats.record(meta.timestampUs, esp_timer_get_time());
+
+      if (m_captureLog.isEnabled()) {
+        m_captureLog.record(packet.data, packet.length, meta);  // Raw bytes, before decryption
+      }
+
+      if (m_survey->isRunning()) {
+        m_survey->recordPacket(meta);  // Per-preset statistics, CRC errors included
+      }
+
+      if (!meta.crcOk) {
+        ESP_LOGW(TAG, "CRC error, %u byte packet skipped", meta.length);
+        m_LoRaCom->releasePacket();
+        continue;
+      }
+
+      // Addresses and signal values are taken from this packet's own record,
+      // so each queued POST describes the packet it was built for
+      MeshHeaderView header(packet.data, packet.length);
+      // A full status packet is long enough for a header too, but its "from"
+      // and "id" are fixed text and would make every status packet a duplicate
+      bool meshFrame = header.valid() && !isStatusFrame(packet.data, packet.length);
+      uint32_t destinationId = 0;
+      uint32_t senderId = 1;  // Status or other packet without Meshtastic header
+      if (meshFrame) {
+        destinationId = header.to();
+        senderId = header.from();
+        ESP_LOGI(TAG, "Parsed destination_id: %08lX, sender_id: %08lX, id: %08lX, hops %d/%d%s%s",
+                 (unsigned long)destinationId, (unsigned long)senderId, (unsigned long)header.id(),
+                 header.hopsAway(), header.hopStart(),
+                 header.wantAck() ? ", want_ack" : "", header.viaMqtt() ? ", via_mqtt" : "");
+      }
+
+#if DEDUP_ENABLED
+      // Rebroadcasts of a packet already handled are counted, not uploaded again
+      if (meshFrame) {
+        const DedupCache::Entry *seen = m_dedupCache.checkAndInsert(
+            header.from(), header.id(), header.relayNode(), header.hopsAway(), millis());
+        if (seen) {
+          ESP_LOGI(TAG, "Duplicate %08lX/%08lX copy %u via relay %02X (%d hops), first via %02X, hops %u-%u, skipped",
+                   (unsigned long)seen->from, (unsigned long)seen->id, seen->copies, header.relayNode(),
+                   header.hopsAway(), seen->firstRelay, seen->minHops, seen->maxHops);
+          m_LoRaCom->releasePacket();
+          continue;
+        }
+      }
+#endif
+      // Status packets carry a wrapping counter, gaps in it are lost packets
+      int statusSeq = -1;
+      const LossTracker::SenderLoss *loss = nullptr;
+      if (!meshFrame) {
+        loss = trackStatusCounter(packet.data, packet.length, statusSeq);
+        if (loss) senderId = loss->key;  // Transmitter tag or name hash, for the node table and the POST
+      }
+
+      m_nodeTable.update(senderId, meta.rssi, meta.snr, meshFrame ? header.hopsAway() : NODE_HOPS_UNKNOWN,
+                         meta.timestampUs, millis());
+
+      // Channel payload after the 16-byte header, decrypted where it lies and
+      // counted per application
+      if (meshFrame && m_channelCrypto.isEnabled() && packet.length > MESH_HEADER_LEN) {
+        uint32_t airtimeUs = m_LoRaCom->getTimeOnAirUs(packet.length);
+        MeshDataInfo data;
+        int channel = m_channelCrypto.decrypt(header.channelHash(), header.from(), header.id(),
+                                              packet.slotData + MESH_HEADER_LEN, packet.length - MESH_HEADER_LEN,
+                                              airtimeUs, decodeMeshData, &data);
+        if (channel >= 0) {
+          m_portStats.record(data, airtimeUs);
+          ESP_LOGD(TAG, "Channel %d, portnum %lu, %u byte payload%s%s", channel, (unsigned long)data.portnum,
+                   (unsigned)data.payloadSize, data.wantResponse ? ", want_response" : "",
+                   data.isReply() ? ", reply" : "");
+        } else {
+          m_portStats.recordUndecoded(airtimeUs);
+          ESP_LOGD(TAG, "Channel hash %02X: no key", header.channelHash());
+        }
+      }
+
+      int32_t packetRssi = abs((int32_t)meta.rssi);
+
+      // Keep the "last packet" values for manual send_post and status commands
+      if (POST_EN_WHEN_LORA_RECEIVED || force_lora_trigger) {
+        m_wifiManager->setLoRaRssi(packetRssi);
+        if (meshFrame) {
+          m_wifiManager->setLastDestinationId(destinationId);
+          m_wifiManager->setLastSenderId(senderId);
+        }
+        m_wifiManager->setLastFullPacketLen(meta.length);  // Set full packet length for Flask server
+        m_wifiManager->setSendPostOnLoRa(true);
+      }
       // Log first few bytes in hex for debugging
       if (receivedLen > 0) {
-        char hexBuf[64];
+        char hexBuf[80];  // 22 byte prefix + 16 * "XX "
         int hexLen = min(16, receivedLen);  // Show first 16 bytes
         sprintf(hexBuf, "First %d bytes (hex): ", hexLen);
         for (int i = 0; i < hexLen; i++) {
@@ -217,9 +348,6 @@ void Control::loRaDataTask() {
         m_serialCom->sendData(buffer);
         m_serialCom->sendData(">\n");
 
-        // Save to flash for logging all received LoRa messages
-        //m_saveFlash->writeData((String("RX: ") + buffer + "\n").c_str());
-
         // POST on LoRa receive disabled for stability
         ESP_LOGI(TAG, "OLD_LORA_PARS=1: Simple processing completed, alarm_time=01");
       } else {
@@ -242,14 +370,9 @@ void Control::loRaDataTask() {
         // Set packet length for POST - use actual received length
         m_wifiManager->setLastLoRaPacketLen(receivedLen);
 
-        // Null-terminate for string operations if needed
-        if (receivedLen < sizeof(buffer)) {
-          buffer[receivedLen] = '\0';
-        }
-
         // Log first few bytes in hex for debugging
         if (receivedLen > 0) {
-          char hexBuf[64];
+          char hexBuf[80];  // 22 byte prefix + 16 * "XX "
           int hexLen = min(16, receivedLen);  // Show first 16 bytes
           sprintf(hexBuf, "First %d bytes (hex): ", hexLen);
           for (int i = 0; i < hexLen; i++) {
@@ -274,19 +397,8 @@ void Control::loRaDataTask() {
           m_serialCom->sendData("LoRa Received: <");
           m_serialCom->sendData(buffer);
           m_serialCom->sendData(">\n");
-
-          // Save to flash for logging all received LoRa messages
-          //m_saveFlash->writeData((String("RX: ") + buffer + "\n").c_str());
         } else {
           ESP_LOGI(TAG, "Received binary packet (%d bytes), skipping text interpretation", receivedLen);
-          // Save to flash as hex dump for binary packets
-          char hexDump[512];
-          sprintf(hexDump, "RX_BIN: %d bytes - ", receivedLen);
-          int hexLen = min(32, receivedLen);  // Show first 32 bytes
-          for (int i = 0; i < hexLen; i++) {
-            sprintf(hexDump + strlen(hexDump), "%02X ", (uint8_t)buffer[i]);
-          }
-          ///m_saveFlash->writeData((String(hexDump) + "\n").c_str());
         }
       }
 
@@ -307,11 +419,11 @@ void Control::loRaDataTask() {
 
         int alarm_value = ALARM_TIME + random(0, 10000);
         if (POST_SEND_SENDER_ID_AS_ALARM_TIME) {
-          alarm_value = m_wifiManager->getLastSenderId() & 0xFFFF;
+          alarm_value = senderId & 0xFFFF;
         }
         long hot_value;
         if (post_on_lora) {
-          hot_value = POST_HOT_AS_RSSI ? m_wifiManager->getLastRssi() : hot_counter;
+          hot_value = POST_HOT_AS_RSSI ? packetRssi : hot_counter;
         } else {
           hot_value = hot_counter;
         }
@@ -329,7 +441,7 @@ void Control::loRaDataTask() {
         long failed_count = wifiMgr->getFailedRequests();  // Get failed requests count
 
         // Use fake RSSI counter for FAKE_LORA mode debugging (0 to INT_MAX)
-        int signal_level_dbm = FAKE_LORA ? fake_rssi_counter++ : m_wifiManager->getLastRssi();
+        int signal_level_dbm = FAKE_LORA ? fake_rssi_counter++ : packetRssi;
 
         String postData;
         if (USE_FLASK_SERVER) {
@@ -340,8 +452,28 @@ void Control::loRaDataTask() {
           postData = "{";
           postData += "\"user_id\":\"" + m_wifiManager->getUserId() + "\",";
           postData += "\"user_location\":\"" + m_wifiManager->getUserLocation() + "\",";
-          postData += "\"sender_nodeid\":\"" + m_wifiManager->getLastSenderIdHex() + "\",";
-          postData += "\"destination_nodeid\":\"" + m_wifiManager->getLastDestinationIdHex() + "\",";
+          postData += "\"sender_nodeid\":\"" + m_wifiManager->uint32ToHexString(senderId) + "\",";
+          postData += "\"destination_nodeid\":\"" + m_wifiManager->uint32ToHexString(destinationId) + "\",";
+          if (meshFrame) {
+            // packet_id column is a signed INTEGER, send the raw 32 bits
+            postData += "\"packet_id\":" + String((int32_t)header.id()) + ",";
+            postData += "\"header_flags\":" + String(header.flags()) + ",";
+            postData += "\"channel_hash\":" + String(header.channelHash()) + ",";
+            postData += "\"next_hop\":" + String(header.nextHop()) + ",";
+            postData += "\"relay_node\":" + String(header.relayNode()) + ",";
+          }
+          if (loss) {
+            // Status counter as packet_id, delivery ratio (per mille) in the spare integer column
+            if (!meshFrame) postData += "\"packet_id\":" + String(statusSeq) + ",";
+            postData += "\"additional_field3\":" + String((int)(loss->pdr() * 10)) + ",";
+          }
+          if (m_LoRaCom->isNoiseSamplerEnabled()) {
+            NoiseStats noise = m_LoRaCom->getNoiseStats();
+            postData += "\"noise_floor_dbm\":" + String((int)noise.floorDbm) + ",";
+            postData += "\"channel_busy\":" + String((int)(noise.busyPercent + noise.loraPercent)) + ",";
+          }
+          // Uptime at the RX interrupt: against created_at it gives the queueing and batching delay
+          postData += "\"rx_uptime_ms\":" + String((unsigned long)(meta.timestampUs / 1000)) + ",";
           postData += "\"full_packet_len\":" + String(packet_len_value) + ",";
           postData += "\"signal_level_dbm\":" + String(signal_level_dbm) + ",";
           postData += "\"cold\":" + String(received_count) + ",";
@@ -369,55 +501,111 @@ void Control::loRaDataTask() {
       }
       ESP_LOGI(TAG, "=== POST TRIGGER DEBUG END ===");
 
-      memset(buffer, 0, sizeof(buffer));
+      m_LoRaCom->releasePacket();
     }
 
-    // Reduce CPU wakeups when WiFi off: longer delay
-    int delay_ms = wifi_enabled ? 10 : 100;
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    // Sleep until the radio task queues a packet, the timeout is only a safety net
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LORA_RX_WAIT_TIMEOUT_MS));
   }
 }
 
 void Control::statusTask() {
-  static unsigned long lastStatusTime = 0;
-  static uint16_t packetCounter = 0;  // Counter for short packets
-
   while (true) {
     if (statusEnabled) {
       // Process any pending LoRa operations first
       // m_LoRaCom->processOperations();
 
-      String msg;
-      if (!LORA_STATUS_SHORT_PACKETS) {
-        // Full packet: st ID:transceiver R:-63 B:100.00 M:transceive S:ok
-        int32_t rssi = m_LoRaCom->getRssi();
-        msg = String("st ") + "ID:" + deviceID +
-              " R:" + String(rssi) +
-              " B:" + String(m_batteryLevel) + " M:" + m_mode +
-              " S:" + m_status;
-      } else {
-        // Short packet: 2-byte hex counter, e.g. "00", "01"...
-        char buf[3];
-        sprintf(buf, "%02X", packetCounter++ % 256);  // Wrap at 255
-        msg = String(buf);
-      }
+      String msg = buildStatusMessage();
 
       // Send over serial first (this should be fast)
       m_serialCom->sendData(((msg + "\n").c_str()));
 
       // Send over LoRa
       ESP_LOGD(TAG, "Sending status over LoRa: %s", msg.c_str());
-      m_LoRaCom->sendMessage(msg.c_str());
-
-      // Wait for LoRa transmission to complete
-      while (m_LoRaCom->checkTxMode()) {
-        vTaskDelay(pdMS_TO_TICKS(10));  // Wait for LoRa transmission
-      }
+      m_LoRaCom->sendMessage(msg.c_str());  // Queued, the radio task transmits it
     }
     vTaskDelay(pdMS_TO_TICKS(status_Interval));
   }
 }
 
+String Control::buildStatusMessage() {
+  uint8_t seq = m_statusCounter++;  // One wrapping counter for both formats, for loss tracking
+  char buf[8];
+  if (LORA_STATUS_SHORT_PACKETS) {
+    // Short packet: hex counter and transmitter tag, e.g. "1F" "E5F6"
+    sprintf(buf, "%02X%04X", seq, m_txTag);
+    return String(buf);
+  }
+  // Full packet: st ID:transceiver R:-63 B:100.00 M:transceive S:ok N:1F
+  int32_t rssi = m_LoRaCom->getRssi();
+  String msg = String("st ") + "ID:" + deviceID +
+               " R:" + String(rssi) +
+               " B:" + String(m_batteryLevel) + " M:" + m_mode +
+               " S:" + m_status;
+  if (m_LoRaCom->isNoiseSamplerEnabled()) {
+    // Local noise floor and busy share, so the far end can tell interference from a weak link
+    NoiseStats noise = m_LoRaCom->getNoiseStats();
+    msg += " NF:" + String((int)noise.floorDbm) + " CB:" + String((int)(noise.busyPercent + noise.loraPercent));
+  }
+  sprintf(buf, "%02X", seq);
+  msg += String(" N:") + buf;
+  return msg;
+}
+
+static bool isHexText(const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (!isxdigit(data[i])) return false;
+  }
+  return true;
+}
+
+bool Control::isStatusFrame(const uint8_t *data, size_t length) {
+  if (length >= 3 && memcmp(data, "st ", 3) == 0) return true;
+  return (length == STATUS_SHORT_LEN || length == STATUS_SHORT_LEN_OLD) && isHexText(data, length);
+}
+
+const LossTracker::SenderLoss *Control::trackStatusCounter(const uint8_t *data, size_t length, int &seq) {
+  char label[16];
+  const char *hex = nullptr;
+  uint32_t key;
+
+  if (length == STATUS_SHORT_LEN && isHexText(data, length)) {
+    // Short packet: counter, then the transmitter tag (end of its MAC address)
+    hex = (const char *)data;
+    key = strtoul((const char *)data + 2, nullptr, 16);
+    sprintf(label, "tx%04lX", (unsigned long)key);
+  } else if (length == STATUS_SHORT_LEN_OLD && isHexText(data, length)) {
+    // Counter only, from firmware before the tag: all such transmitters share one entry
+    hex = (const char *)data;
+    key = STATUS_KEY_UNTAGGED;
+    strcpy(label, "untagged");
+  } else if (length >= 3 && memcmp(data, "st ", 3) == 0) {
+    // Full packet: "st ID:<name> ... N:<counter>", keyed by the device name.
+    // The slot keeps a '\0' after the packet, so it can be searched as text.
+    const char *text = (const char *)data;
+    const char *id = strstr(text, "ID:");
+    const char *n = strstr(text, " N:");
+    if (!id || !n || !isxdigit(n[3]) || !isxdigit(n[4])) return nullptr;
+    id += 3;
+    size_t idLen = strcspn(id, " ");
+    if (idLen >= sizeof(label)) idLen = sizeof(label) - 1;
+    memcpy(label, id, idLen);
+    label[idLen] = '\0';
+    key = 2166136261UL;  // FNV-1a of the name
+    for (size_t i = 0; i < idLen; i++) key = (key ^ (uint8_t)label[i]) * 16777619UL;
+    hex = n + 3;
+  } else {
+    return nullptr;
+  }
+
+  char digits[3] = {hex[0], hex[1], '\0'};
+  seq = (int)strtol(digits, nullptr, 16);
+  const LossTracker::SenderLoss *loss = m_lossTracker.record(key, label, (uint8_t)seq, millis());
+  ESP_LOGI(TAG, "Status counter %02X from %s: pdr %.1f%%, lost %lu, max burst %lu", seq, loss->label, loss->pdr(),
+           (unsigned long)loss->lost, (unsigned long)loss->maxBurst);
+  return loss;
+}
+
 void Control::interpretMessage(const char *buffer, bool relayMsgLoRa) {
   m_commander->setCommand(buffer);  // Set the command in the commander
   char *token = m_commander->readAndRemove();
@@ -442,31 +630,14 @@ void Control::interpretMessage(const char *buffer, bool relayMsgLoRa) {
 
           // Send first status packet immediately when enabled
           if (state) {
-            String msg;
-            if (!LORA_STATUS_SHORT_PACKETS) {
-              int32_t rssi = m_LoRaCom->getRssi();
-              msg = String("st ") + "ID:" + deviceID +
-                    " R:" + String(rssi) +
-                    " B:" + String(m_batteryLevel) + " M:" + m_mode +
-                    " S:" + m_status;
-            } else {
-              static uint16_t initCounter = 0;  // For initial packet
-              char buf[3];
-              sprintf(buf, "%02X", initCounter++);
-              msg = String(buf);
-            }
+            String msg = buildStatusMessage();
 
             // Send over serial first
             m_serialCom->sendData(((msg + "\n").c_str()));
 
             // Send over LoRa
             ESP_LOGD(TAG, "Sending initial status over LoRa: %s", msg.c_str());
-            m_LoRaCom->sendMessage(msg.c_str());
-
-            // Wait for LoRa transmission to complete
-            while (m_LoRaCom->checkTxMode()) {
-              vTaskDelay(pdMS_TO_TICKS(10));
-            }
+            m_LoRaCom->sendMessage(msg.c_str());  // Queued, the radio task transmits it
           }
 
           return;  // Handled
@@ -479,6 +650,74 @@ void Control::interpretMessage(const char *buffer, bool relayMsgLoRa) {
           ESP_LOGI(TAG, "Status interval set to %d seconds", interval_sec);
           return;  // Handled
         }
+      } else if (c_cmp(cmd_token, "lbt")) {
+        cmd_token = m_commander->readAndRemove();  // value
+        if (cmd_token) {
+          bool state = (atoi(cmd_token) == 1);
+          m_LoRaCom->setLbtEnabled(state);
+          ESP_LOGI(TAG, "Listen-before-talk %s", state ? "enabled" : "disabled");
+          return;  // Handled
+        }
+      } else if (c_cmp(cmd_token, "hop")) {
+        cmd_token = m_commander->readAndRemove();  // value
+        if (cmd_token) {
+          if (atoi(cmd_token) == 1) {
+            if (m_survey->isRunning()) {
+              ESP_LOGW(TAG, "Survey is running, stop it first (command mode survey stop)");
+            } else {
+              m_LoRaCom->startHopping();
+            }
+          } else {
+            m_LoRaCom->stopHopping();
+          }
+          return;  // Handled
+        }
+      } else if (c_cmp(cmd_token, "noise")) {
+        cmd_token = m_commander->readAndRemove();  // value
+        if (cmd_token) {
+          m_LoRaCom->setNoiseSamplerEnabled(atoi(cmd_token) == 1);
+          return;  // Handled
+        }
+      } else if (c_cmp(cmd_token, "decrypt")) {
+        cmd_token = m_commander->readAndRemove();  // value
+        if (cmd_token) {
+          m_channelCrypto.setEnabled(atoi(cmd_token) == 1);
+          ESP_LOGI(TAG, "Channel decryption %s", m_channelCrypto.isEnabled() ? "enabled" : "disabled");
+          return;  // Handled
+        }
+      } else if (c_cmp(cmd_token, "capture")) {
+        cmd_token = m_commander->readAndRemove();  // 0, 1 or clear
+        if (cmd_token) {
+          if (c_cmp(cmd_token, "clear")) {
+            m_captureLog.clear();
+          } else {
+            m_captureLog.setEnabled(atoi(cmd_token) == 1);
+          }
+          return;  // Handled
+        }
+      } else if (c_cmp(cmd_token, "channel")) {
+        char *name = m_commander->readAndRemove();
+        cmd_token = m_commander->readAndRemove();  // PSK in base64 or "off"
+        if (name && cmd_token) {
+          if (c_cmp(cmd_token, "off")) {
+            m_channelCrypto.removeChannel(name);
+          } else {
+            uint8_t psk[MESH_KEY_MAX];
+            int pskLength = base64Decode(cmd_token, psk, sizeof(psk));
+            if (pskLength < 0) {
+              ESP_LOGW(TAG, "Channel %s: PSK is not base64 or longer than %d bytes", name, MESH_KEY_MAX);
+            } else {
+              m_channelCrypto.setChannel(name, psk, pskLength);
+            }
+          }
+          return;  // Handled
+        }
+      } else if (c_cmp(cmd_token, "fake_busy")) {
+        cmd_token = m_commander->readAndRemove();  // number of busy CAD scans
+        if (cmd_token) {
+          m_LoRaCom->setFakeBusyScans(atoi(cmd_token));
+          return;  // Handled
+        }
       } else if (c_cmp(cmd_token, "wifi_en")) {
         cmd_token = m_commander->readAndRemove();  // value
         if (cmd_token) {
@@ -522,9 +761,6 @@ void Control::interpretMessage(const char *buffer, bool relayMsgLoRa) {
     if (relayMsgLoRa) {
       // send to other devices to sync parameters
       m_LoRaCom->sendMessage(buffer);
-      while (m_LoRaCom->checkTxMode()) {
-        vTaskDelay(pdMS_TO_TICKS(10));  // Wait for LoRa transmission
-      }
     }
     // should probably wait for a success reply before changing THIS device
     ESP_LOGD(TAG, "Processing command: %s", cmd_start);
@@ -598,6 +834,178 @@ void Control::interpretMessage(const char *buffer, bool relayMsgLoRa) {
         String password = getWiFiPassword();
         m_serialCom->sendData(("password " + password + "\n").c_str());
         return;
+      } else if (c_cmp(get_token, "rx_latency")) {
+        RxLatencyStats latency = m_LoRaCom->getRxLatencyStats();
+        char buf[128];
+        sprintf(buf, "rx_latency last_us=%lu avg_us=%lu min_us=%lu max_us=%lu count=%lu\n",
+                (unsigned long)latency.lastUs, (unsigned long)latency.avgUs(), (unsigned long)latency.minUs,
+                (unsigned long)latency.maxUs, (unsigned long)latency.count);
+        m_serialCom->sendData(buf);
+        return;
+      } else if (c_cmp(get_token, "rx_ring")) {
+        char buf[96];
+        sprintf(buf, "rx_ring size=%u used=%u high_water=%lu dropped=%lu\n",
+                (unsigned)m_LoRaCom->getRxRingCapacity(), (unsigned)m_LoRaCom->getRxRingUsed(),
+                (unsigned long)m_LoRaCom->getRxRingHighWater(), (unsigned long)m_LoRaCom->getRxRingDropped());
+        m_serialCom->sendData(buf);
+        return;
+      } else if (c_cmp(get_token, "tx_queue")) {
+        char buf[96];
+        sprintf(buf, "tx_queue size=%d used=%u sent=%lu failed=%lu dropped=%lu\n", LORA_TX_QUEUE_SIZE,
+                (unsigned)m_LoRaCom->getTxQueued(), (unsigned long)m_LoRaCom->getTxSent(),
+                (unsigned long)m_LoRaCom->getTxFailed(), (unsigned long)m_LoRaCom->getTxDropped());
+        m_serialCom->sendData(buf);
+        return;
+      } else if (c_cmp(get_token, "airtime")) {
+        AirtimeStats airtime = m_LoRaCom->getAirtimeStats();
+        // Shortest interval that keeps frames like the last one inside the duty cycle
+        unsigned long minIntervalMs = (unsigned long)((uint64_t)airtime.lastTxToaUs * airtime.windowMs / (airtime.budgetUs ? airtime.budgetUs : 1));
+        char buf[256];
+        sprintf(buf, "airtime window_s=%lu tx_ms=%lu budget_ms=%lu remaining_ms=%lu tx_util=%.2f%% channel_util=%.2f%% "
+                "last_toa_ms=%.1f last_tx_ms=%.1f min_interval_ms=%lu deferred=%lu\n",
+                (unsigned long)(airtime.windowMs / 1000), (unsigned long)(airtime.txUs / 1000),
+                (unsigned long)(airtime.budgetUs / 1000), (unsigned long)(airtime.remainingUs() / 1000),
+                airtime.txUtilisation(), airtime.channelUtilisation(), airtime.lastTxToaUs / 1000.0f,
+                airtime.lastTxAirUs / 1000.0f, minIntervalMs, (unsigned long)airtime.deferred);
+        m_serialCom->sendData(buf);
+        return;
+      } else if (c_cmp(get_token, "hop")) {
+        HopPreset presets[RX_HOP_MAX_PRESETS];
+        HopStats stats[RX_HOP_MAX_PRESETS];
+        HopSummary summary;
+        size_t count = m_LoRaCom->getHopStats(presets, stats, RX_HOP_MAX_PRESETS, &summary);
+        char buf[160];
+        float lostPct = summary.runMs ? (summary.lostUs / 10.0f) / summary.runMs : 0;
+        sprintf(buf, "hop active=%d current=%d run_s=%lu lost_ms=%lu lost=%.3f%%\n", summary.active, summary.current,
+                (unsigned long)(summary.runMs / 1000), (unsigned long)(summary.lostUs / 1000), lostPct);
+        m_serialCom->sendData(buf);
+        for (size_t i = 0; i < count; i++) {
+          sprintf(buf, "hop %u %s SF%d BW%.0f pkts=%lu crc=%lu listen_s=%lu visits=%lu holds=%lu\n", (unsigned)i,
+                  presets[i].name, presets[i].sf, presets[i].bwKHz, (unsigned long)stats[i].packets,
+                  (unsigned long)stats[i].crcErrors, (unsigned long)(stats[i].listenMs / 1000),
+                  (unsigned long)stats[i].visits, (unsigned long)stats[i].holds);
+          m_serialCom->sendData(buf);
+        }
+        return;
+      } else if (c_cmp(get_token, "lbt")) {
+        LbtStats lbt = m_LoRaCom->getLbtStats();
+        char buf[128];
+        sprintf(buf, "lbt enabled=%d busy=%lu deferred=%lu forced=%lu backoff_ms=%lu\n", m_LoRaCom->isLbtEnabled(),
+                (unsigned long)lbt.busy, (unsigned long)lbt.deferred, (unsigned long)lbt.forced,
+                (unsigned long)lbt.backoffMs);
+        m_serialCom->sendData(buf);
+        return;
+      } else if (c_cmp(get_token, "dedup")) {
+        char buf[96];
+        sprintf(buf, "dedup unique=%lu duplicates=%lu ratio=%.1f%% evicted=%lu\n",
+                (unsigned long)m_dedupCache.getUnique(), (unsigned long)m_dedupCache.getDuplicates(),
+                m_dedupCache.getDedupRatio(), (unsigned long)m_dedupCache.getEvicted());
+        m_serialCom->sendData(buf);
+        return;
+      } else if (c_cmp(get_token, "loss")) {
+        // One line per transmitter, gaps: bursts of 1,2,3,4,5-8,9-16,17-64,>64 lost packets
+        // Worst case: 15-char label, 6 counters, pdr and LOSS_GAP_BINS bins of 10 digits, about 250 bytes
+        char buf[320];
+        size_t shown = 0;
+        for (size_t i = 0; i < m_lossTracker.size(); i++) {
+          const LossTracker::SenderLoss &loss = m_lossTracker.at(i);
+          if (!loss.used) continue;
+          size_t len = snprintf(buf, sizeof(buf),
+                                "loss %s rx=%lu lost=%lu pdr=%.1f%% reordered=%lu dup=%lu restarts=%lu max_burst=%lu gaps=",
+                                loss.label, (unsigned long)loss.received, (unsigned long)loss.lost, loss.pdr(),
+                                (unsigned long)loss.reordered, (unsigned long)loss.duplicates,
+                                (unsigned long)loss.restarts, (unsigned long)loss.maxBurst);
+          for (size_t b = 0; b < LOSS_GAP_BINS && len < sizeof(buf); b++) {
+            len += snprintf(buf + len, sizeof(buf) - len, "%s%lu", b == 0 ? "" : ",", (unsigned long)loss.gapHist[b]);
+          }
+          if (len > sizeof(buf) - 2) len = sizeof(buf) - 2;  // Truncated, the line still ends
+          buf[len++] = '\n';
+          buf[len] = '\0';
+          m_serialCom->sendData(buf);
+          shown++;
+        }
+        if (shown == 0) m_serialCom->sendData("loss none\n");
+        return;
+      } else if (c_cmp(get_token, "arrival")) {
+        char *text = (char *)malloc(ARRIVAL_TEXT_MAX);
+        if (text) {
+          m_arrivalStats.write(text, ARRIVAL_TEXT_MAX);
+          m_serialCom->sendData(text);
+          free(text);
+        }
+        return;
+      } else if (c_cmp(get_token, "periods")) {
+        char *frame = (char *)malloc(NODE_FRAME_MAX);
+        if (frame) {
+          m_nodeTable.writePeriods(frame, NODE_FRAME_MAX);
+          m_serialCom->sendData(frame);
+          free(frame);
+        }
+        return;
+      } else if (c_cmp(get_token, "nodes")) {
+        // Whole table in one line so a reader never sees half an update
+        char *frame = (char *)malloc(NODE_FRAME_MAX);
+        if (frame) {
+          m_nodeTable.writeFrame(frame, NODE_FRAME_MAX, millis());
+          m_serialCom->sendData(frame);
+          free(frame);
+        }
+        return;
+      } else if (c_cmp(get_token, "noise")) {
+        NoiseStats noise = m_LoRaCom->getNoiseStats();
+        char buf[160];
+        sprintf(buf, "noise enabled=%d floor_dbm=%.0f last_dbm=%.1f busy=%.1f%% lora=%.1f%% window=%u samples=%lu in_flight=%lu rearms=%lu\n",
+                noise.enabled, noise.floorDbm, noise.lastDbm, noise.busyPercent, noise.loraPercent,
+                (unsigned)noise.window, (unsigned long)noise.samples, (unsigned long)noise.inFlight,
+                (unsigned long)noise.rearms);
+        m_serialCom->sendData(buf);
+        return;
+      } else if (c_cmp(get_token, "decrypt")) {
+        ChannelCrypto::Stats stats = m_channelCrypto.getStats();
+        char buf[256];
+        // load: AES time per time on air of the same packets, must stay far below 100%
+        sprintf(buf, "decrypt enabled=%d decrypted=%lu plain=%lu no_key=%lu rejected=%lu last_us=%lu avg_us=%.1f max_us=%lu bytes=%llu load=%.4f%%\n",
+                m_channelCrypto.isEnabled(), (unsigned long)stats.decrypted, (unsigned long)stats.plain,
+                (unsigned long)stats.noKey, (unsigned long)stats.rejected, (unsigned long)stats.lastUs,
+                stats.decrypted ? (float)stats.totalUs / stats.decrypted : 0.0f, (unsigned long)stats.maxUs,
+                (unsigned long long)stats.bytes, stats.airtimeUs ? 100.0 * stats.totalUs / stats.airtimeUs : 0.0);
+        m_serialCom->sendData(buf);
+        ChannelCrypto::Channel channel;
+        for (size_t i = 0; i < MESH_MAX_CHANNELS; i++) {
+          if (!m_channelCrypto.getChannel(i, channel)) continue;
+          sprintf(buf, "channel %u %s hash=%02X key=%s packets=%lu\n", (unsigned)i, channel.name, channel.hash,
+                  channel.keyLength == 0 ? "none" : (channel.keyLength == 16 ? "aes128" : "aes256"),
+                  (unsigned long)channel.packets);
+          m_serialCom->sendData(buf);
+        }
+        return;
+      } else if (c_cmp(get_token, "http_conn")) {
+        HttpUploadStats http = m_wifiManager->getUploadStats();
+        uint32_t sent = http.connects + http.reuses;
+        char buf[560];  // 304 characters of format and 21 values, up to 10 digits each
+        // reuse: requests that skipped the TCP + TLS handshake; tls_resumed: handshakes that skipped the certificate
+        snprintf(buf, sizeof(buf), "http_conn open=%d idle_ms=%lu requests=%lu failures=%lu connects=%lu reuses=%lu reuse=%.1f%% stale_retries=%lu handshake_last_ms=%lu handshake_avg_ms=%lu handshake_max_ms=%lu request_last_ms=%lu request_avg_ms=%lu request_max_ms=%lu tls_full=%lu tls_resumed=%lu tls_full_last_ms=%lu tls_full_avg_ms=%lu tls_resumed_last_ms=%lu tls_resumed_avg_ms=%lu tls_heap_bytes=%ld\n",
+                 http.connected, (unsigned long)http.idleMs, (unsigned long)http.requests, (unsigned long)http.failures,
+                 (unsigned long)http.connects, (unsigned long)http.reuses, sent ? 100.0f * http.reuses / sent : 0.0f,
+                 (unsigned long)http.staleRetries, (unsigned long)http.lastHandshakeMs,
+                 (unsigned long)http.avgHandshakeMs, (unsigned long)http.maxHandshakeMs,
+                 (unsigned long)http.lastRequestMs, (unsigned long)http.avgRequestMs, (unsigned long)http.maxRequestMs,
+                 (unsigned long)http.fullHandshakes, (unsigned long)http.resumedHandshakes,
+                 (unsigned long)http.lastFullMs, (unsigned long)http.avgFullMs, (unsigned long)http.lastResumedMs,
+                 (unsigned long)http.avgResumedMs, (long)http.tlsHeapBytes);
+        m_serialCom->sendData(buf);
+        return;
+      } else if (c_cmp(get_token, "capture")) {
+        sendCaptureStatus();
+        return;
+      } else if (c_cmp(get_token, "ports")) {
+        char *text = (char *)malloc(PORT_STATS_TEXT_MAX);
+        if (text) {
+          if (m_portStats.write(text, PORT_STATS_TEXT_MAX) == 0) strcpy(text, "port none\n");
+          m_serialCom->sendData(text);
+          free(text);
+        }
+        return;
       } else if (c_cmp(get_token, "send_post")) {
         ESP_LOGI(TAG, "Manual POST trigger command received");
         m_wifiManager->sendSinglePost();
@@ -610,20 +1018,86 @@ void Control::interpretMessage(const char *buffer, bool relayMsgLoRa) {
     ESP_LOGI(TAG,
              "Message format: <type> <data1> <data2> ...\n"
              "Valid types:\n"
-             "  - flash: for flash read and save\n"
              "  - command: for device control\n"
              "  - data: for data transmission\n"
              "  - message: for standard messages\n"
-             "  - flash: to print and auto erase logs\n"
+             "  - flash [export <offset>]: packet capture status, or its bulk export from offset\n"
              "  - status: for device status\n"
              "  - help: for displaying help information");
   } else if (token != nullptr && c_cmp(token, "flash")) {
-    //m_saveFlash->readFile();
-    //m_saveFlash->removeFile();  // Update the flash storage
-    //m_saveFlash->begin();       // Reinitialize the flash storage
+    m_commander->setCommand(buffer);
+    char *flash_token = m_commander->readAndRemove();  // "flash"
+    flash_token = m_commander->readAndRemove();        // "export" or nothing
+    if (flash_token && c_cmp(flash_token, "export")) {
+      if (!relayMsgLoRa) {
+        // Streaming the log blocks this task for a minute, nobody on air may trigger it
+        ESP_LOGW(TAG, "flash export received over LoRa, ignored (serial only)");
+        return;
+      }
+      flash_token = m_commander->readAndRemove();  // Resume offset, optional
+      exportCapture(flash_token ? strtoul(flash_token, nullptr, 10) : 0);
+    } else {
+      sendCaptureStatus();
+    }
   }
 }
 
+void Control::sendCaptureStatus() {
+  CaptureStats stats = m_captureLog.getStats();
+  char buf[320];
+  sprintf(buf, "capture enabled=%d ready=%d records=%lu bytes=%llu dropped=%lu pages=%lu write_errors=%lu last_write_us=%lu max_write_us=%lu buffered=%lu generation=%lu segment=%u page=%u next_seq=%lu\n",
+          stats.enabled, stats.ready, (unsigned long)stats.records, (unsigned long long)stats.bytes,
+          (unsigned long)stats.dropped, (unsigned long)stats.pagesWritten, (unsigned long)stats.writeErrors,
+          (unsigned long)stats.lastWriteUs, (unsigned long)stats.maxWriteUs, (unsigned long)stats.pagesBuffered,
+          (unsigned long)stats.generation, (unsigned)stats.segment, (unsigned)stats.page,
+          (unsigned long)stats.nextSeq);
+  m_serialCom->sendData(buf);
+}
+
+void Control::exportCapture(uint32_t offset) {
+  // One line per flash page with records, only its valid part:
+  //   capture_chunk n=<index in this export> off=<byte offset in the log> len=<bytes> crc=<crc32 hex> <base64>
+  // A chunk with a bad CRC (a log line cut into it) is fetched again with
+  // "flash export <off>", every chunk from there on is sent again. Empty pages
+  // are skipped, so a lost or garbled chunk shows up as a gap in n.
+  const size_t lineSize = 80 + BASE64_ENCODED_SIZE(CAPTURE_PAGE_SIZE);
+  uint8_t *page = (uint8_t *)malloc(CAPTURE_PAGE_SIZE);
+  char *line = (char *)malloc(lineSize);
+  if (!page || !line) {
+    free(page);
+    free(line);
+    m_serialCom->sendData("capture_end error=no_memory\n");
+    return;
+  }
+
+  m_captureLog.flush(1000);  // Newest records too, not only what the last interval flushed
+  offset -= offset % CAPTURE_PAGE_SIZE;
+  sprintf(line, "capture_begin from=%lu size=%lu page=%u segment_bytes=%lu\n", (unsigned long)offset,
+          (unsigned long)CAPTURE_LOG_BYTES, (unsigned)CAPTURE_PAGE_SIZE, (unsigned long)CAPTURE_SEGMENT_BYTES);
+  m_serialCom->sendData(line);
+
+  uint32_t chunks = 0;
+  uint32_t bytes = 0;
+  int64_t startUs = esp_timer_get_time();
+  for (; offset < CAPTURE_LOG_BYTES; offset += CAPTURE_PAGE_SIZE) {
+    size_t length = m_captureLog.readPage(offset, page);
+    if (length == 0) continue;
+    int n = sprintf(line, "capture_chunk n=%lu off=%lu len=%u crc=%08lx ", (unsigned long)chunks,
+                    (unsigned long)offset, (unsigned)length, (unsigned long)crc32Update(0, page, length));
+    n += base64Encode(page, length, line + n, lineSize - n - 1);
+    line[n++] = '\n';
+    line[n] = '\0';
+    m_serialCom->sendData(line);
+    chunks++;
+    bytes += length;
+  }
+  sprintf(line, "capture_end chunks=%lu bytes=%lu ms=%lu\n", (unsigned long)chunks, (unsigned long)bytes,
+          (unsigned long)((esp_timer_get_time() - startUs) / 1000));
+  m_serialCom->sendData(line);
+  free(page);
+  free(line);
+}
+
 void Control::processData(const char *buffer) {
   // Process the data message - send to LoRa
   ESP_LOGD(TAG, "Processing data for LoRa transmission");
@@ -643,9 +1117,6 @@ void Control::processData(const char *buffer) {
   m_serialCom->sendData(dataStart);
   m_serialCom->sendData("Data sent to LoRa: ");
 
-  // Also save to flash for logging
-  //m_saveFlash->writeData((String("TX: ") + dataStart + "\n").c_str());
-
   ESP_LOGI(TAG, "Data sent to LoRa: %s", dataStart);
 }
 
@@ -6,14 +6,23 @@
 
 #include "../lora_config.hpp"
 #include "../wifi_manager/wifi_manager.hpp"
-#include "LoRaCom.hpp"
+#include "LoRaComT.hpp"
+#include "MeshHeader.hpp"
 #include "SerialCom.hpp"
 #include "esp_log.h"
 
 class Commander;  // Forward declaration
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "../fileSystem/saveFlash.hpp"
+#include "../fileSystem/CaptureLog.hpp"
+#include "../meshDecode/ChannelCrypto.hpp"
+#include "../packetStats/ArrivalStats.hpp"
+#include "../packetStats/DedupCache.hpp"
+#include "../packetStats/LossTracker.hpp"
+#include "../packetStats/NodeTable.hpp"
+#include "../packetStats/PortStats.hpp"
+#include "../ping/PingTest.hpp"
+#include "../survey/Survey.hpp"
 
 #define c_cmp(a, b) (strcmp(a, b) == 0)
 
@@ -62,12 +71,17 @@ class Control {
   bool getPostOnLora() const { return post_on_lora; }
   bool isStatusEnabled() const { return statusEnabled; }
   LoRaCom* getLoRaCom() { return m_LoRaCom; }
+  Survey* getSurvey() { return m_survey; }
+  PingTest* getPing() { return m_ping; }
+  const DedupCache& getDedupCache() const { return m_dedupCache; }
+  const LossTracker& getLossTracker() const { return m_lossTracker; }
 
  private:
   SerialCom *m_serialCom;
   LoRaCom *m_LoRaCom;
   Commander *m_commander;
-  SaveFlash *m_saveFlash;
+  Survey *m_survey;
+  PingTest *m_ping;
 
   unsigned long serial_Interval = 100;
   unsigned long lora_Interval = 100;
@@ -80,15 +94,32 @@ class Control {
   TaskHandle_t StatusTaskHandle = nullptr;
 
   WiFiManager *m_wifiManager;
+  DedupCache m_dedupCache;  // Recently uploaded (from, id) pairs
+  LossTracker m_lossTracker;  // Status packet counters per transmitter
+  NodeTable m_nodeTable;      // Everyone heard on air, per sender id
+  ChannelCrypto m_channelCrypto;  // Known channel keys, payloads decrypted in the slot
+  PortStats m_portStats;          // Decrypted traffic per Meshtastic application
+  ArrivalStats m_arrivalStats;    // Spacing of receptions and the pipeline latency at that spacing
+  CaptureLog m_captureLog;        // Raw received packets, paged to LittleFS
   volatile bool post_on_lora = POST_EN_WHEN_LORA_RECEIVED;
   volatile bool wifi_enabled = WIFI_ENABLE;
 
   void serialDataTask();
   void loRaDataTask();
   void statusTask();
+  // Short status packet: 2 hex digits of counter, 4 of transmitter tag
+  static constexpr size_t STATUS_SHORT_LEN = 6;
+  static constexpr size_t STATUS_SHORT_LEN_OLD = 2;  // Counter only
+  static constexpr uint32_t STATUS_KEY_UNTAGGED = 0xFFFFFFFF;
+  // The tester's own "st ..." or counter packets, never Meshtastic
+  static bool isStatusFrame(const uint8_t *data, size_t length);
+  const LossTracker::SenderLoss *trackStatusCounter(const uint8_t *data, size_t length, int &seq);
+  String buildStatusMessage();
 
   void interpretMessage(const char *buffer, bool relayMsgLoRa = true);
   void processData(const char *buffer);
+  void sendCaptureStatus();
+  void exportCapture(uint32_t offset);
 
   String deviceID = "transceiver";  // Unique identifier for the device
 
@@ -96,6 +127,8 @@ class Control {
   String m_mode = "transceive";
   String m_status = "ok";  // Status of the device (e.g., "ok", "error", etc.)
   float m_batteryLevel = 100.0;  // Battery level as a percentage (0-100)
+  uint8_t m_statusCounter = 0;   // Wrapping counter in every status packet
+  uint16_t m_txTag = 0;          // Last two bytes of the MAC, tells short status packets apart
 
   // Data payload;
 };
@@ -0,0 +1,398 @@
+// CaptureLog.cpp
+#include "CaptureLog.hpp"
+
+#include "Crc32.hpp"
+
+// index + 1 in sealPage must still fit the byte to reach CAPTURE_SEGMENT_PAGES
+static_assert(CAPTURE_SEGMENTS <= 256 && CAPTURE_SEGMENT_PAGES < 256, "segment and page numbers are kept in a byte");
+
+CaptureLog::CaptureLog() {
+  m_mutex = xSemaphoreCreateMutex();
+  m_fileMutex = xSemaphoreCreateMutex();
+}
+
+void CaptureLog::begin() {
+  if (m_taskHandle == nullptr) {
+    // Below the packet tasks, flash writes only ever delay other flash writes
+    xTaskCreate(writerTaskWrapper, "CaptureTask", 4096, this, 1, &m_taskHandle);
+  }
+}
+
+void CaptureLog::segmentPath(uint8_t segment, char *path, size_t size) {
+  snprintf(path, size, "/capture/seg%u.bin", segment);
+}
+
+void CaptureLog::setEnabled(bool enabled) {
+  m_enabled = enabled;
+  ESP_LOGI(TAG, "Packet capture %s", enabled ? "enabled" : "disabled");
+}
+
+void CaptureLog::clear() {
+  m_clearRequested = true;
+  if (m_taskHandle) xTaskNotifyGive(m_taskHandle);
+}
+
+bool CaptureLog::flush(uint32_t timeoutMs) {
+  if (!m_ready || m_taskHandle == nullptr) return false;
+  m_flushRequested = true;
+  xTaskNotifyGive(m_taskHandle);
+  uint32_t startMs = millis();
+  while (m_flushRequested && millis() - startMs < timeoutMs) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  return !m_flushRequested;
+}
+
+/* ================================= RECORDING ================================ */
+
+bool CaptureLog::record(const uint8_t *data, size_t length, const RxMetadata &meta) {
+  if (!m_enabled || !m_ready || length > LORA_PACKET_SLOT_SIZE) return false;
+  size_t size = sizeof(CaptureRecordHeader) + length;
+
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  Page *page = &m_pages[m_fill];
+  if (page->used + size > CAPTURE_PAGE_SIZE) {
+    if (!sealPage()) {
+      m_dropped++;
+      xSemaphoreGive(m_mutex);
+      return false;
+    }
+    page = &m_pages[m_fill];
+  }
+
+  CaptureRecordHeader header;
+  header.magic = CAPTURE_RECORD_MAGIC;
+  header.length = length;
+  header.seq = m_nextSeq;
+  header.timestampUs = meta.timestampUs;
+  header.rssiDeci = (int16_t)lroundf(meta.rssi * 10);
+  header.snrQuarter = (int8_t)lroundf(meta.snr * 4);
+  header.flags = meta.crcOk ? CAPTURE_FLAG_CRC_OK : 0;
+  header.sf = meta.sf;
+  header.cr = meta.cr;
+  header.bwDeci = (uint16_t)lroundf(meta.bw * 10);
+  header.freqErrorHz = (int32_t)meta.freqErrorHz;
+  header.crc = 0;
+  uint32_t crc = crc32Update(0, &page->generation, sizeof(page->generation));
+  crc = crc32Update(crc, &header, sizeof(header));
+  header.crc = crc32Update(crc, data, length);
+
+  memcpy(page->data + page->used, &header, sizeof(header));
+  memcpy(page->data + page->used + sizeof(header), data, length);
+  page->used += size;
+  m_nextSeq++;
+  m_records++;
+  m_bytes += size;
+  xSemaphoreGive(m_mutex);
+  return true;
+}
+
+void CaptureLog::startPage(Page &page, uint8_t segment, uint8_t index, uint32_t generation) {
+  page.used = 0;
+  page.segment = segment;
+  page.index = index;
+  page.generation = generation;
+  if (index == 0) {
+    CaptureSegmentHeader header;
+    header.magic = CAPTURE_SEGMENT_MAGIC;
+    header.version = CAPTURE_VERSION;
+    header.pageSize = CAPTURE_PAGE_SIZE;
+    header.generation = generation;
+    header.firstSeq = m_nextSeq;
+    memcpy(page.data, &header, sizeof(header));
+    page.used = sizeof(header);
+  }
+  m_partialWritten = 0;
+}
+
+bool CaptureLog::sealPage() {
+  // The page after the fill page must be free, one is always kept for appending
+  if (m_sealed + 1 >= CAPTURE_BUFFER_PAGES) return false;
+  const Page &full = m_pages[m_fill];
+  uint8_t segment = full.segment;
+  uint8_t index = full.index + 1;
+  uint32_t generation = full.generation;
+  if (index == CAPTURE_SEGMENT_PAGES) {
+    // Next segment of the ring, its previous contents stop validating
+    index = 0;
+    segment = (segment + 1) % CAPTURE_SEGMENTS;
+    generation = ++m_generation;
+  }
+  m_sealed++;
+  m_fill = (m_fill + 1) % CAPTURE_BUFFER_PAGES;
+  startPage(m_pages[m_fill], segment, index, generation);
+  if (m_taskHandle) xTaskNotifyGive(m_taskHandle);
+  return true;
+}
+
+size_t CaptureLog::checkRecord(const uint8_t *page, size_t offset, uint32_t generation) {
+  CaptureRecordHeader header;
+  if (offset + sizeof(header) > CAPTURE_PAGE_SIZE) return 0;
+  memcpy(&header, page + offset, sizeof(header));
+  if (header.magic != CAPTURE_RECORD_MAGIC || header.length > LORA_PACKET_SLOT_SIZE) return 0;
+  size_t size = sizeof(header) + header.length;
+  if (offset + size > CAPTURE_PAGE_SIZE) return 0;
+
+  uint32_t stored = header.crc;
+  header.crc = 0;
+  uint32_t crc = crc32Update(0, &generation, sizeof(generation));
+  crc = crc32Update(crc, &header, sizeof(header));
+  crc = crc32Update(crc, page + offset + sizeof(header), header.length);
+  return crc == stored ? size : 0;
+}
+
+bool CaptureLog::checkSegmentHeader(const CaptureSegmentHeader &header) {
+  return header.magic == CAPTURE_SEGMENT_MAGIC && header.version == CAPTURE_VERSION &&
+         header.pageSize == CAPTURE_PAGE_SIZE;
+}
+
+size_t CaptureLog::readPage(uint32_t offset, uint8_t *page) {
+  if (offset % CAPTURE_PAGE_SIZE != 0 || offset >= CAPTURE_LOG_BYTES) return 0;
+  uint8_t segment = offset / CAPTURE_SEGMENT_BYTES;
+  uint32_t pageOffset = offset % CAPTURE_SEGMENT_BYTES;
+  char path[32];
+  segmentPath(segment, path, sizeof(path));
+
+  CaptureSegmentHeader header;
+  xSemaphoreTake(m_fileMutex, portMAX_DELAY);
+  File file = LittleFS.open(path, FILE_READ);
+  bool ok = file && file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) && checkSegmentHeader(header) &&
+            file.seek(pageOffset) && file.read(page, CAPTURE_PAGE_SIZE) == CAPTURE_PAGE_SIZE;
+  file.close();
+  xSemaphoreGive(m_fileMutex);
+  if (!ok) return 0;
+
+  // Stops at the first record that does not validate, the page is filled in order
+  size_t end = pageOffset == 0 ? sizeof(header) : 0;
+  size_t size;
+  while ((size = checkRecord(page, end, header.generation)) != 0) end += size;
+  return end;
+}
+
+CaptureStats CaptureLog::getStats() {
+  CaptureStats stats;
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  stats.enabled = m_enabled;
+  stats.ready = m_ready;
+  stats.records = m_records;
+  stats.bytes = m_bytes;
+  stats.dropped = m_dropped;
+  stats.pagesWritten = m_pagesWritten;
+  stats.writeErrors = m_writeErrors;
+  stats.lastWriteUs = m_lastWriteUs;
+  stats.maxWriteUs = m_maxWriteUs;
+  stats.pagesBuffered = m_sealed + (m_pages[m_fill].used > m_partialWritten ? 1 : 0);
+  stats.generation = m_generation;
+  stats.segment = m_pages[m_fill].segment;
+  stats.page = m_pages[m_fill].index;
+  stats.nextSeq = m_nextSeq;
+  xSemaphoreGive(m_mutex);
+  return stats;
+}
+
+/* ================================ WRITER TASK =============================== */
+
+void CaptureLog::writerTaskWrapper(void *param) {
+  static_cast<CaptureLog *>(param)->writerTask();
+}
+
+void CaptureLog::writerTask() {
+  prepareSegments();
+  recoverPosition();
+  m_ready = true;
+
+  uint32_t lastPartialMs = millis();
+  while (true) {
+    // Woken when a page is sealed, the timeout bounds how long a partial page stays in RAM
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAPTURE_FLUSH_INTERVAL_MS));
+    if (m_clearRequested) {
+      eraseSegments();
+    }
+    writeSealedPages();
+    if (m_flushRequested || millis() - lastPartialMs >= CAPTURE_FLUSH_INTERVAL_MS) {
+      writePartialPage();
+      lastPartialMs = millis();
+      m_flushRequested = false;
+    }
+  }
+}
+
+void CaptureLog::prepareSegments() {
+  if (!LittleFS.begin()) {
+    ESP_LOGE(TAG, "LittleFS not mounted, capture log unavailable");
+    vTaskDelete(nullptr);
+    return;
+  }
+  LittleFS.mkdir("/capture");
+
+  // Allocated once at full size, so a running capture never grows a file
+  uint8_t *zeros = nullptr;
+  char path[32];
+  for (uint8_t segment = 0; segment < CAPTURE_SEGMENTS; segment++) {
+    segmentPath(segment, path, sizeof(path));
+    File file = LittleFS.open(path, FILE_READ);
+    size_t size = file ? file.size() : 0;
+    file.close();
+    if (size == CAPTURE_SEGMENT_BYTES) continue;
+
+    if (!zeros) zeros = (uint8_t *)calloc(1, CAPTURE_PAGE_SIZE);
+    file = LittleFS.open(path, FILE_WRITE);
+    bool ok = zeros && file;
+    for (size_t page = 0; ok && page < CAPTURE_SEGMENT_PAGES; page++) {
+      ok = file.write(zeros, CAPTURE_PAGE_SIZE) == CAPTURE_PAGE_SIZE;
+    }
+    file.close();
+    if (ok) {
+      ESP_LOGI(TAG, "Allocated %s (%u bytes)", path, (unsigned)CAPTURE_SEGMENT_BYTES);
+    } else {
+      ESP_LOGE(TAG, "Failed to allocate %s", path);
+    }
+  }
+  free(zeros);
+}
+
+void CaptureLog::recoverPosition() {
+  // Newest segment by generation, the next run starts in the one after it
+  CaptureSegmentHeader newest = {};
+  int newestSegment = -1;
+  char path[32];
+  for (uint8_t segment = 0; segment < CAPTURE_SEGMENTS; segment++) {
+    segmentPath(segment, path, sizeof(path));
+    File file = LittleFS.open(path, FILE_READ);
+    CaptureSegmentHeader header;
+    if (!file || file.read((uint8_t *)&header, sizeof(header)) != sizeof(header)) continue;
+    if (!checkSegmentHeader(header)) continue;
+    if (newestSegment < 0 || header.generation > newest.generation) {
+      newest = header;
+      newestSegment = segment;
+    }
+  }
+
+  uint32_t nextSeq = 0;
+  if (newestSegment >= 0) {
+    // Sequence numbers carry on after the last record that validates
+    nextSeq = newest.firstSeq;
+    uint8_t *page = (uint8_t *)malloc(CAPTURE_PAGE_SIZE);
+    segmentPath(newestSegment, path, sizeof(path));
+    File file = LittleFS.open(path, FILE_READ);
+    for (size_t index = 0; page && file && index < CAPTURE_SEGMENT_PAGES; index++) {
+      if (file.read(page, CAPTURE_PAGE_SIZE) != CAPTURE_PAGE_SIZE) break;
+      size_t offset = index == 0 ? sizeof(CaptureSegmentHeader) : 0;
+      size_t size;
+      while ((size = checkRecord(page, offset, newest.generation)) != 0) {
+        CaptureRecordHeader header;
+        memcpy(&header, page + offset, sizeof(header));
+        nextSeq = header.seq + 1;
+        offset += size;
+      }
+    }
+    free(page);
+  }
+
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  m_generation = newestSegment >= 0 ? newest.generation + 1 : 1;
+  m_nextSeq = nextSeq;
+  uint8_t segment = newestSegment >= 0 ? (newestSegment + 1) % CAPTURE_SEGMENTS : 0;
+  startPage(m_pages[m_fill], segment, 0, m_generation);
+  xSemaphoreGive(m_mutex);
+  ESP_LOGI(TAG, "Capture log resumes in segment %u, generation %lu, seq %lu", segment,
+           (unsigned long)m_generation, (unsigned long)nextSeq);
+}
+
+void CaptureLog::eraseSegments() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  m_ready = false;  // record() stays out until the ring is reset
+  m_sealed = 0;
+  xSemaphoreGive(m_mutex);
+
+  xSemaphoreTake(m_fileMutex, portMAX_DELAY);
+  m_file.close();
+  m_fileSegment = -1;
+  const CaptureSegmentHeader blank = {};
+  char path[32];
+  for (uint8_t segment = 0; segment < CAPTURE_SEGMENTS; segment++) {
+    segmentPath(segment, path, sizeof(path));
+    File file = LittleFS.open(path, "r+");
+    if (file) file.write((const uint8_t *)&blank, sizeof(blank));
+  }
+  xSemaphoreGive(m_fileMutex);
+
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  // Generations keep counting up, records of the erased log can never validate again
+  m_generation++;
+  m_nextSeq = 0;
+  m_records = 0;
+  m_bytes = 0;
+  m_dropped = 0;
+  startPage(m_pages[m_fill], 0, 0, m_generation);
+  m_clearRequested = false;
+  m_ready = true;
+  xSemaphoreGive(m_mutex);
+  ESP_LOGI(TAG, "Capture log cleared");
+}
+
+void CaptureLog::writeSealedPages() {
+  while (true) {
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    if (m_sealed == 0) {
+      xSemaphoreGive(m_mutex);
+      return;
+    }
+    // record() no longer touches a sealed page, it is written without the lock
+    const Page &page = m_pages[(m_fill + CAPTURE_BUFFER_PAGES - m_sealed) % CAPTURE_BUFFER_PAGES];
+    size_t length = page.used;
+    xSemaphoreGive(m_mutex);
+
+    writePage(page, length);
+
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    m_sealed--;
+    xSemaphoreGive(m_mutex);
+  }
+}
+
+void CaptureLog::writePartialPage() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  const Page *page = &m_pages[m_fill];
+  size_t length = page->used;
+  bool pending = length > m_partialWritten;
+  xSemaphoreGive(m_mutex);
+  if (!pending) return;
+
+  // Only the bytes below length are read, record() keeps appending behind them
+  if (!writePage(*page, length)) return;
+
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  if (page == &m_pages[m_fill]) m_partialWritten = length;
+  xSemaphoreGive(m_mutex);
+}
+
+bool CaptureLog::writePage(const Page &page, size_t length) {
+  if (m_fileSegment != page.segment) {
+    char path[32];
+    segmentPath(page.segment, path, sizeof(path));
+    m_file.close();
+    m_file = LittleFS.open(path, "r+");  // Preallocated, never truncated
+    m_fileSegment = m_file ? page.segment : -1;
+  }
+
+  xSemaphoreTake(m_fileMutex, portMAX_DELAY);
+  int64_t startUs = esp_timer_get_time();
+  bool ok = m_file && m_file.seek((uint32_t)page.index * CAPTURE_PAGE_SIZE) &&
+            m_file.write(page.data, length) == length;
+  if (ok) m_file.flush();
+  uint32_t writeUs = (uint32_t)(esp_timer_get_time() - startUs);
+  xSemaphoreGive(m_fileMutex);
+
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  if (ok) {
+    m_pagesWritten++;
+    m_lastWriteUs = writeUs;
+    if (writeUs > m_maxWriteUs) m_maxWriteUs = writeUs;
+  } else {
+    m_writeErrors++;
+  }
+  xSemaphoreGive(m_mutex);
+  if (!ok) ESP_LOGE(TAG, "Write of segment %u page %u failed", page.segment, page.index);
+  return ok;
+}
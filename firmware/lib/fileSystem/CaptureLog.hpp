@@ -0,0 +1,155 @@
+// CaptureLog.hpp
+#ifndef CaptureLog_h
+#define CaptureLog_h
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+#include "LittleFS.h"
+#include "PacketRing.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define CAPTURE_SEGMENT_MAGIC 0x5350414Cu  // "LAPS" little endian
+#define CAPTURE_RECORD_MAGIC 0xCA57
+#define CAPTURE_VERSION 1
+#define CAPTURE_SEGMENT_BYTES ((size_t)CAPTURE_PAGE_SIZE * CAPTURE_SEGMENT_PAGES)
+#define CAPTURE_LOG_BYTES (CAPTURE_SEGMENT_BYTES * CAPTURE_SEGMENTS)  // Segments back to back, as exported
+
+// First bytes of every segment file. The segment with the highest generation
+// is the one written last.
+struct CaptureSegmentHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t pageSize;
+  uint32_t generation;  // Counts segment starts over the life of the log
+  uint32_t firstSeq;    // Sequence number of the first record in the segment
+};
+
+// One received packet, followed by length raw bytes as they came off the air.
+// crc is CRC-32 over the segment generation, this header with crc = 0 and the
+// data, so records left over from an older pass of the ring never validate.
+struct CaptureRecordHeader {
+  uint16_t magic;
+  uint16_t length;
+  uint32_t seq;
+  int64_t timestampUs;  // esp_timer time of the RX interrupt
+  int16_t rssiDeci;     // 0.1 dBm
+  int8_t snrQuarter;    // 0.25 dB, as the SX126x reports it
+  uint8_t flags;        // CAPTURE_FLAG_*
+  uint8_t sf;
+  uint8_t cr;
+  uint16_t bwDeci;      // 0.1 kHz
+  int32_t freqErrorHz;
+  uint32_t crc;
+};
+#define CAPTURE_FLAG_CRC_OK 0x01
+
+static_assert(sizeof(CaptureSegmentHeader) == 16, "segment header layout is part of the file format");
+static_assert(sizeof(CaptureRecordHeader) == 32, "record header layout is part of the file format");
+static_assert(sizeof(CaptureSegmentHeader) + sizeof(CaptureRecordHeader) + LORA_PACKET_SLOT_SIZE <= CAPTURE_PAGE_SIZE,
+              "a record never spans two pages");
+
+struct CaptureStats {
+  bool enabled = false;
+  bool ready = false;        // Segments allocated and the write position recovered
+  uint32_t records = 0;
+  uint64_t bytes = 0;
+  uint32_t dropped = 0;      // No free RAM page, the flash writer is behind
+  uint32_t pagesWritten = 0;
+  uint32_t writeErrors = 0;
+  uint32_t lastWriteUs = 0;  // Flash time of one page write
+  uint32_t maxWriteUs = 0;
+  uint32_t pagesBuffered = 0;
+  uint32_t generation = 0;
+  uint8_t segment = 0;
+  uint8_t page = 0;
+  uint32_t nextSeq = 0;
+};
+
+// Packet capture on LittleFS: a ring of CAPTURE_SEGMENTS preallocated files.
+// record() copies the packet into a RAM page and returns; full pages are
+// written whole by a background task, a partly filled page at least every
+// CAPTURE_FLUSH_INTERVAL_MS. Records never cross a page, the rest of a page
+// that does not fit the next record is left unused.
+class CaptureLog {
+ public:
+  CaptureLog();
+
+  // Starts the writer task, which allocates the segments and finds where the
+  // previous run stopped. LittleFS must be mountable.
+  void begin();
+
+  bool record(const uint8_t *data, size_t length, const RxMetadata &meta);
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const { return m_enabled; }
+  // Invalidates every segment, the next record starts a fresh log
+  void clear();
+  CaptureStats getStats();
+
+  // Puts the page being filled on flash now instead of at the next flush
+  // interval, waits up to timeoutMs for the writer
+  bool flush(uint32_t timeoutMs);
+  // Reads the page at offset of CAPTURE_LOG_BYTES into page (CAPTURE_PAGE_SIZE
+  // bytes). Returns how much of it is valid: the segment header and the
+  // records that pass their CRC; 0 for an empty page or an unused segment.
+  size_t readPage(uint32_t offset, uint8_t *page);
+
+  static void segmentPath(uint8_t segment, char *path, size_t size);
+  // Validates one record inside a page buffer, returns its total size or 0
+  static size_t checkRecord(const uint8_t *page, size_t offset, uint32_t generation);
+  static bool checkSegmentHeader(const CaptureSegmentHeader &header);
+
+ private:
+  static constexpr const char *TAG = "CaptureLog";
+
+  struct Page {
+    uint8_t data[CAPTURE_PAGE_SIZE];
+    size_t used;
+    uint8_t segment;
+    uint8_t index;      // Page number inside the segment
+    uint32_t generation;
+  };
+
+  Page m_pages[CAPTURE_BUFFER_PAGES];
+  size_t m_fill = 0;      // Page record() appends to
+  size_t m_sealed = 0;    // Full pages waiting for the writer, oldest at m_fill - m_sealed
+  size_t m_partialWritten = 0;  // Bytes of the fill page already on flash
+
+  volatile bool m_enabled = CAPTURE_ENABLED;
+  volatile bool m_ready = false;
+  volatile bool m_clearRequested = false;
+  volatile bool m_flushRequested = false;
+  uint32_t m_generation = 0;
+  uint32_t m_nextSeq = 0;
+
+  uint32_t m_records = 0;
+  uint64_t m_bytes = 0;
+  uint32_t m_dropped = 0;
+  uint32_t m_pagesWritten = 0;
+  uint32_t m_writeErrors = 0;
+  uint32_t m_lastWriteUs = 0;
+  uint32_t m_maxWriteUs = 0;
+
+  File m_file;
+  int m_fileSegment = -1;
+
+  SemaphoreHandle_t m_mutex = nullptr;  // LoRa task records, writer task drains, serial task reads stats
+  SemaphoreHandle_t m_fileMutex = nullptr;  // Page writes against export reads, no page is read half written
+  TaskHandle_t m_taskHandle = nullptr;
+
+  static void writerTaskWrapper(void *param);
+  void writerTask();
+  void prepareSegments();
+  void recoverPosition();
+  void eraseSegments();
+  void startPage(Page &page, uint8_t segment, uint8_t index, uint32_t generation);
+  bool sealPage();
+  void writeSealedPages();
+  void writePartialPage();
+  bool writePage(const Page &page, size_t length);
+};
+
+#endif
@@ -0,0 +1,30 @@
+// Crc32.hpp
+#ifndef Crc32_h
+#define Crc32_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3, reflected, as zlib), table built at compile time.
+// crc32Update() continues a running CRC, start from 0.
+struct Crc32Table {
+  uint32_t entries[256];
+
+  constexpr Crc32Table() : entries() {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      entries[i] = c;
+    }
+  }
+};
+
+inline uint32_t crc32Update(uint32_t crc, const void *data, size_t length) {
+  static constexpr Crc32Table table;
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  crc = ~crc;
+  while (length--) crc = table.entries[(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+#endif
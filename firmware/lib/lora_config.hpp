@@ -21,6 +21,42 @@
 // Режим симуляции: если 1, пропустить инициализацию аппаратного LoRa и использовать фейковый режим
 #define FAKE_LORA 0
 
+// Максимальное ожидание LoRa задачи между прерываниями DIO1 (страховка, прием будится прерыванием)
+#define LORA_RX_WAIT_TIMEOUT_MS 1000
+// Емкость кольцевого буфера принятых пакетов между радио задачей и обработкой (степень двойки)
+#define LORA_RX_RING_SIZE 8
+// Количество кадров в очереди на передачу (send() не блокирует, при переполнении кадр отбрасывается)
+#define LORA_TX_QUEUE_SIZE 8
+
+// Ограничение duty cycle передатчика (EU868: 868.0-868.6 и 869.7-870.0 МГц - 1%, 868.7-869.2 МГц - 0.1%, 869.4-869.65 МГц - 10%)
+#define TX_DUTY_CYCLE_LIMIT_ENABLED 1  // Если 1, кадры сверх бюджета эфирного времени ждут в очереди
+#define TX_DUTY_CYCLE_PERMILLE 10  // Доля эфирного времени в промилле (10 = 1%, для 868.7-869.2 МГц установить 1)
+#define TX_DUTY_CYCLE_WINDOW_MS 3600000  // Скользящее окно учета эфирного времени (1 час)
+
+// Listen-before-talk: CAD перед каждой передачей и случайная задержка, если канал занят
+#define LBT_ENABLED 0  // Значение по умолчанию, переключается командой "command set lbt 0/1"
+#define LBT_BACKOFF_MIN_MS 20  // Минимальная задержка после занятого CAD
+#define LBT_BACKOFF_MAX_MS 640  // Максимальное окно случайной задержки (удваивается с каждой попыткой)
+#define LBT_MAX_ATTEMPTS 6  // После стольких занятых CAD кадр передается без проверки
+
+// Подавление дубликатов Meshtastic пакетов (ретрансляции одного пакета) перед отправкой на сервер
+#define DEDUP_ENABLED 1
+#define DEDUP_CACHE_SIZE 64  // Количество запоминаемых пакетов (степень двойки)
+#define DEDUP_WINDOW_MS 300000  // Сколько мс пакет считается недавним (повторы за это время не отправляются)
+
+// Таблица узлов в эфире ("get nodes"): статистика по каждому отправителю
+#define NODE_TABLE_SIZE 32  // Количество узлов (степень двойки), самый давний вытесняется
+#define NODE_EWMA_ALPHA 0.125f  // Вес нового пакета в скользящем среднем RSSI/SNR
+#define NODE_RSSI_BINS 7  // Гистограмма RSSI: <-120, шаг 10 дБм, >=-70
+#define NODE_PERIOD_BINS 8  // Гистограмма периода узла ("get periods"): <10 с, <30 с, <1 мин, <5 мин, <15 мин, <30 мин, <1 ч, >=1 ч
+
+// Интервалы между приемами ("get arrival") по времени прерывания RX, с задержкой обработки в каждом интервале
+#define ARRIVAL_HIST_BINS 16  // Гистограмма: <1 мс, [1,2), [2,4) ... мс, последний >= 2^(N-2) мс
+
+// Учет потерь по счетчику статус пакетов (00..FF) для каждого передатчика
+#define LOSS_MAX_SENDERS 8  // Количество отслеживаемых передатчиков
+#define LOSS_REORDER_WINDOW 32  // Насколько поздно может прийти пакет, чтобы считаться переупорядоченным (не больше 32)
+
 // Интервал отправки статусов (можно изменить через команды)
 extern unsigned long status_Interval;
 
@@ -43,7 +79,8 @@ extern unsigned long status_Interval;
 
 #define USE_SYSTEM_NETWORK
 
-#ifdef USE_SYSTEM_NETWORK
+// Сборка native (firmware/native) всегда берет резервные значения
+#if defined(USE_SYSTEM_NETWORK) && !defined(NATIVE_BUILD)
 #include "../../../network_definitions.h"
 #else
 #include "fake_network_definitions.h"  // Резервные значения по умолчанию
@@ -67,8 +104,15 @@ extern unsigned long status_Interval;
 #define PING_INTERVAL_MS 5000  // Интервал между ping в мс
 #define SERVER_CONNECTION_TIMEOUT_MS 5000  // Таймаут на установление соединения с сервером
 #define WIFI_POST_DELAY_MS 10000  // Задержка после подключения WiFi перед отправкой initial POST
-#define POST_RESPONSE_INITIAL_DELAY_MS 1000  // Начальная задержка перед ожиданием ответа сервера
 #define POST_RESPONSE_TOTAL_TIMEOUT_MS 8000  // Общий таймаут ожидания ответа сервера
+// Одно HTTP/1.1 keep-alive соединение (TCP + TLS) на все POST запросы, статистика: get http_conn
+#define HTTP_KEEPALIVE 1  // Если 0, соединение закрывается после каждого запроса (Connection: close)
+#define HTTP_KEEPALIVE_IDLE_MS 50000  // Закрыть простаивающее соединение раньше сервера (nginx keepalive_timeout 75 с)
+#define HTTP_KEEPALIVE_MAX_REQUESTS 1000  // Переподключение после стольких запросов (nginx keepalive_requests)
+// Возобновление TLS сессии при переподключении (session ticket или session ID) вместо полного рукопожатия
+#define TLS_SESSION_RESUME 1  // Если 0, каждое подключение выполняет полное рукопожатие
+#define TLS_SESSION_RTC 0  // Если 1, сессия хранится и в RTC памяти и переживает deep sleep
+#define TLS_SESSION_RTC_BYTES 2048  // Размер буфера сессии в RTC памяти (сессия с ticket ~300-1200 байт)
 #define HOT_WATER 0  // Значение по умолчанию для поля hot water
 #define ALARM_TIME 200  // Поле alarm time
 
@@ -78,7 +122,7 @@ extern unsigned long status_Interval;
 // Настройки периодической отправки LoRa статусов
 #define LORA_STATUS_ENABLED 0  // Включить/отключить периодические LoRa статус пакеты
 #define LORA_STATUS_INTERVAL_SEC 10  // Интервал по умолчанию для LoRa статус пакетов в секундах
-#define LORA_STATUS_SHORT_PACKETS 1  // 0=полный пакет, 1=короткий 2-байтовый счетчик
+#define LORA_STATUS_SHORT_PACKETS 1  // 0=полный пакет, 1=короткий: 2 hex цифры счетчика + 4 hex цифры конца MAC передатчика
 
 // Совместимость с Mesh
 #define MESH_COMPATIBLE 1  // Если 1, установить BW/SF/CR/sync для соответствия Meshtastic SHORT_FAST при приеме их пакетов
@@ -88,8 +132,61 @@ extern unsigned long status_Interval;
 #define MESH_SPREADING_FACTOR 11  // SF для Mesh (сопоставлено с Meshtastic для trace пакетов)
 #define MESH_CODING_RATE 5  // CR для Mesh
 
+// Расшифровка каналов Meshtastic (AES-CTR через mbedtls, на ESP32-C3 аппаратный AES) по channel_hash заголовка.
+// "command set decrypt 0/1", "command set channel <имя> <psk base64>|off", "get decrypt"
+#define MESH_DECRYPT_ENABLED 1
+#define MESH_MAX_CHANNELS 8  // Максимальное количество каналов с ключами
+#define MESH_DEFAULT_CHANNEL "LongFast"  // Канал с ключом по умолчанию (PSK "AQ==") при старте, "" - без каналов
+
+// Прием с перебором пресетов Meshtastic одним радио (по расписанию, "command set hop 0/1")
+#define RX_HOP_ENABLED 0  // Если 1, включить перебор пресетов при старте
+#define RX_HOP_MAX_PRESETS 8  // Максимальное количество пресетов
+#define RX_HOP_MAX_HOLD_MS 3000  // Насколько можно продлить прослушивание, пока принимается пакет (preamble/header обнаружен)
+// {имя, частота МГц, SF, BW кГц, CR, sync word, время прослушивания мс}
+#define RX_HOP_PRESETS { \
+    {"LONG_FAST", MESH_FREQUENCY, 11, 250.0f, 5, MESH_SYNC_WORD, 4000}, \
+    {"MEDIUM_FAST", MESH_FREQUENCY, 9, 250.0f, 5, MESH_SYNC_WORD, 2000}, \
+    {"SHORT_FAST", MESH_FREQUENCY, 7, 250.0f, 5, MESH_SYNC_WORD, 1000}, \
+}
+
 // Выбор режима приема
 #define DUTY_CYCLE_RECEPTION 1  // Если 1, использовать Meshtastic-style duty cycle reception (энергоэффективный); если 0, использовать continuous receive (для тестирования трафика)
+// Фоновый замер шума между пакетами ("command set noise 0/1", "get noise"). Пока включен, прием непрерывный (DUTY_CYCLE_RECEPTION не действует)
+#define NOISE_SAMPLER_ENABLED 0
+#define NOISE_SAMPLE_INTERVAL_MS 200  // Интервал между замерами RSSI
+#define NOISE_WINDOW_SAMPLES 128  // Размер окна замеров (128 x 200 мс = ~25 с)
+#define NOISE_FLOOR_PERCENTILE 10  // Уровень шума = этот перцентиль замеров
+#define NOISE_BUSY_MARGIN_DB 10  // Канал занят, если RSSI выше уровня шума на столько дБ
+
+// Режим обзора эфира ("command mode survey start"): перебор пресетов, статистика пакетов по каждому
+#define SURVEY_DWELL_MS 60000  // Время прослушивания одного пресета
+#define SURVEY_MAX_PRESETS 16  // Максимальное количество пресетов в списке
+#define SURVEY_RSSI_BINS 7  // Гистограмма RSSI: <-120, шаг 10 дБм, >=-70
+// Пресеты по умолчанию: {частота МГц, SF, BW кГц, CR, sync word}
+#define SURVEY_DEFAULT_PRESETS { \
+    {869.525f, 11, 250.0f, 5, 0x2B},  /* Meshtastic LONG_FAST */ \
+    {869.525f, 9, 250.0f, 5, 0x2B},   /* Meshtastic MEDIUM_FAST */ \
+    {869.525f, 7, 250.0f, 5, 0x2B},   /* Meshtastic SHORT_FAST */ \
+    {869.525f, 12, 125.0f, 8, 0x2B},  /* Meshtastic LONG_SLOW */ \
+    {MESH_FREQUENCY, MESH_SPREADING_FACTOR, MESH_BANDWIDTH, MESH_CODING_RATE, MESH_SYNC_WORD}, \
+    {LORA_FREQUENCY, 11, 250.0f, 5, 0x12},  /* Настройки begin() */ \
+}
+
+// Измерение задержки туда-обратно между двумя узлами ("command mode ping start")
+#define PING_ECHO_ENABLED 0  // Если 1, отвечать на пробы сразу из радио задачи ("command mode ping echo 0/1")
+#define PING_DEFAULT_COUNT 20  // Количество проб за один запуск
+#define PING_PROBE_INTERVAL_MS 5000  // Интервал между пробами (учитывайте лимит duty cycle)
+#define PING_TIMEOUT_MS 4000  // Ожидание ответа на пробу
+#define PING_MAX_SAMPLES 128  // Сколько последних RTT хранить для перцентилей
+
+// Бинарный журнал принятых пакетов на LittleFS ("command set capture 0/1/clear", "get capture").
+// Кольцо из заранее выделенных файлов /capture/segN.bin, пакеты копятся в RAM и пишутся страницами отдельной задачей
+#define CAPTURE_ENABLED 0  // Писать журнал с запуска
+#define CAPTURE_PAGE_SIZE 4096  // Размер записи на флеш (блок LittleFS)
+#define CAPTURE_BUFFER_PAGES 4  // Страниц в RAM между LoRa задачей и записью (при переполнении пакет не пишется)
+#define CAPTURE_SEGMENT_PAGES 16  // Страниц в сегменте (64 КБ), не больше 255
+#define CAPTURE_SEGMENTS 8  // Сегментов в кольце, самый старый перезаписывается
+#define CAPTURE_FLUSH_INTERVAL_MS 5000  // Неполная страница сохраняется не реже этого
 
 
 // Если 1, отправлять длину LoRa packet payload как cold value в POST запросе (когда POST_EN_WHEN_LORA_RECEIVED=1)
@@ -0,0 +1,66 @@
+// Base64.hpp
+#ifndef Base64_h
+#define Base64_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Standard alphabet with '=' padding, the form Meshtastic shows channel keys in
+
+inline int base64Value(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+' || c == '-') return 62;  // '-' and '_' from URL-safe keys
+  if (c == '/' || c == '_') return 63;
+  return -1;
+}
+
+// Returns the decoded length, -1 for a bad character or when out is too small
+inline int base64Decode(const char *in, uint8_t *out, size_t outSize) {
+  uint32_t bits = 0;
+  int bitCount = 0;
+  size_t length = 0;
+  for (; *in != '\0' && *in != '='; in++) {
+    int value = base64Value(*in);
+    if (value < 0) return -1;
+    bits = (bits << 6) | value;
+    bitCount += 6;
+    if (bitCount >= 8) {
+      bitCount -= 8;
+      if (length >= outSize) return -1;
+      out[length++] = (bits >> bitCount) & 0xFF;
+    }
+  }
+  return (int)length;
+}
+
+#define BASE64_ENCODED_SIZE(n) (((n) + 2) / 3 * 4)
+
+// Writes BASE64_ENCODED_SIZE(length) characters and a '\0', returns the
+// character count or -1 when out is too small
+inline int base64Encode(const uint8_t *in, size_t length, char *out, size_t outSize) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t encoded = BASE64_ENCODED_SIZE(length);
+  if (encoded + 1 > outSize) return -1;
+  char *p = out;
+  size_t i = 0;
+  for (; i + 3 <= length; i += 3) {
+    uint32_t bits = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+    *p++ = alphabet[bits >> 18];
+    *p++ = alphabet[(bits >> 12) & 0x3F];
+    *p++ = alphabet[(bits >> 6) & 0x3F];
+    *p++ = alphabet[bits & 0x3F];
+  }
+  if (i < length) {
+    uint32_t bits = (uint32_t)in[i] << 16 | (i + 1 < length ? (uint32_t)in[i + 1] << 8 : 0);
+    *p++ = alphabet[bits >> 18];
+    *p++ = alphabet[(bits >> 12) & 0x3F];
+    *p++ = i + 1 < length ? alphabet[(bits >> 6) & 0x3F] : '=';
+    *p++ = '=';
+  }
+  *p = '\0';
+  return (int)encoded;
+}
+
+#endif
@@ -0,0 +1,176 @@
+// ChannelCrypto.cpp
+#include "ChannelCrypto.hpp"
+
+#include "esp_timer.h"
+
+// Meshtastic default channel key, PSK "AQ=="
+static const uint8_t kDefaultPsk[16] = {0xD4, 0xF1, 0xBB, 0x3A, 0x20, 0x29, 0x07, 0x59,
+                                        0xF0, 0xBC, 0xFF, 0xAB, 0xCF, 0x4E, 0x69, 0x01};
+
+ChannelCrypto::ChannelCrypto() {
+  m_mutex = xSemaphoreCreateMutex();
+  memset(m_channels, 0, sizeof(m_channels));
+  for (size_t i = 0; i < MESH_MAX_CHANNELS; i++) mbedtls_aes_init(&m_aes[i]);
+}
+
+ChannelCrypto::~ChannelCrypto() {
+  for (size_t i = 0; i < MESH_MAX_CHANNELS; i++) mbedtls_aes_free(&m_aes[i]);
+  vSemaphoreDelete(m_mutex);
+}
+
+size_t ChannelCrypto::expandPsk(const uint8_t *psk, size_t pskLength, uint8_t *key) {
+  if (pskLength == 0) return 0;
+  if (pskLength == 1) {
+    if (psk[0] == 0) return 0;
+    memcpy(key, kDefaultPsk, sizeof(kDefaultPsk));
+    key[sizeof(kDefaultPsk) - 1] += psk[0] - 1;
+    return sizeof(kDefaultPsk);
+  }
+  if (pskLength > MESH_KEY_MAX) pskLength = MESH_KEY_MAX;
+  size_t keyLength = pskLength <= 16 ? 16 : 32;
+  memset(key, 0, keyLength);
+  memcpy(key, psk, pskLength);
+  return keyLength;
+}
+
+uint8_t ChannelCrypto::channelHash(const char *name, const uint8_t *key, size_t keyLength) {
+  uint8_t hash = 0;
+  for (; *name; name++) hash ^= (uint8_t)*name;
+  for (size_t i = 0; i < keyLength; i++) hash ^= key[i];
+  return hash;
+}
+
+int ChannelCrypto::find(const char *name) const {
+  for (size_t i = 0; i < MESH_MAX_CHANNELS; i++) {
+    if (m_channels[i].used && strcmp(m_channels[i].name, name) == 0) return i;
+  }
+  return MESH_CHANNEL_NONE;
+}
+
+bool ChannelCrypto::setChannel(const char *name, const uint8_t *psk, size_t pskLength) {
+  if (strlen(name) == 0 || strlen(name) >= sizeof(Channel::name)) {
+    ESP_LOGW(TAG, "Channel name must be 1-%u characters", (unsigned)(sizeof(Channel::name) - 1));
+    return false;
+  }
+  uint8_t key[MESH_KEY_MAX];
+  size_t keyLength = expandPsk(psk, pskLength, key);
+
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  int index = find(name);
+  for (size_t i = 0; index < 0 && i < MESH_MAX_CHANNELS; i++) {
+    if (!m_channels[i].used) index = i;
+  }
+  if (index < 0) {
+    xSemaphoreGive(m_mutex);
+    ESP_LOGW(TAG, "No room for channel %s, %d channels max", name, MESH_MAX_CHANNELS);
+    return false;
+  }
+  Channel &channel = m_channels[index];
+  if (keyLength && mbedtls_aes_setkey_enc(&m_aes[index], key, keyLength * 8) != 0) {
+    xSemaphoreGive(m_mutex);
+    ESP_LOGE(TAG, "AES key setup failed for channel %s", name);
+    return false;
+  }
+  strcpy(channel.name, name);
+  channel.hash = channelHash(name, key, keyLength);
+  channel.keyLength = keyLength;
+  channel.packets = 0;
+  channel.used = true;
+  xSemaphoreGive(m_mutex);
+
+  ESP_LOGI(TAG, "Channel %d %s: hash %02X, %s", index, name, channel.hash,
+           keyLength ? (keyLength == 16 ? "AES-128" : "AES-256") : "no encryption");
+  return true;
+}
+
+bool ChannelCrypto::removeChannel(const char *name) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  int index = find(name);
+  if (index >= 0) m_channels[index].used = false;
+  xSemaphoreGive(m_mutex);
+  return index >= 0;
+}
+
+void ChannelCrypto::clear() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  for (size_t i = 0; i < MESH_MAX_CHANNELS; i++) m_channels[i].used = false;
+  m_stats = Stats();
+  xSemaphoreGive(m_mutex);
+}
+
+int ChannelCrypto::decrypt(uint8_t channelHash, uint32_t from, uint32_t packetId, uint8_t *payload,
+                           size_t length, uint32_t airtimeUs, PayloadCheck check, void *checkContext) {
+  uint8_t nonce[16] = {0};
+  for (size_t i = 0; i < 4; i++) {
+    nonce[i] = (packetId >> (8 * i)) & 0xFF;  // Upper half of the 64-bit id stays 0
+    nonce[8 + i] = (from >> (8 * i)) & 0xFF;
+  }
+
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  int found = MESH_CHANNEL_NONE;
+  bool hashKnown = false;
+  bool ranAes = false;
+  uint32_t aesUs = 0;
+  for (size_t i = 0; i < MESH_MAX_CHANNELS && found < 0; i++) {
+    Channel &channel = m_channels[i];
+    if (!channel.used || channel.hash != channelHash) continue;
+    hashKnown = true;
+    if (channel.keyLength == 0) {
+      if (!check || check(payload, length, checkContext)) found = i;
+      continue;
+    }
+
+    uint8_t counter[16];
+    uint8_t streamBlock[16];
+    size_t streamOffset = 0;
+    memcpy(counter, nonce, sizeof(counter));
+    ranAes = true;
+    int64_t start = esp_timer_get_time();
+    mbedtls_aes_crypt_ctr(&m_aes[i], length, &streamOffset, counter, streamBlock, payload, payload);
+    aesUs += (uint32_t)(esp_timer_get_time() - start);
+    if (!check || check(payload, length, checkContext)) {
+      found = i;
+      continue;
+    }
+    // Wrong key: CTR is its own inverse, a second pass restores the received bytes
+    streamOffset = 0;
+    memcpy(counter, nonce, sizeof(counter));
+    start = esp_timer_get_time();
+    mbedtls_aes_crypt_ctr(&m_aes[i], length, &streamOffset, counter, streamBlock, payload, payload);
+    aesUs += (uint32_t)(esp_timer_get_time() - start);
+  }
+
+  if (found >= 0) {
+    m_channels[found].packets++;
+    if (m_channels[found].keyLength == 0) m_stats.plain++;
+  } else if (hashKnown) {
+    m_stats.rejected++;
+  } else {
+    m_stats.noKey++;
+  }
+  if (ranAes) {
+    m_stats.decrypted++;
+    m_stats.lastUs = aesUs;
+    if (aesUs > m_stats.maxUs) m_stats.maxUs = aesUs;
+    m_stats.totalUs += aesUs;
+    m_stats.airtimeUs += airtimeUs;
+    m_stats.bytes += length;
+  }
+  xSemaphoreGive(m_mutex);
+  return found;
+}
+
+ChannelCrypto::Stats ChannelCrypto::getStats() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  Stats stats = m_stats;
+  xSemaphoreGive(m_mutex);
+  return stats;
+}
+
+bool ChannelCrypto::getChannel(size_t index, Channel &out) {
+  if (index >= MESH_MAX_CHANNELS) return false;
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  out = m_channels[index];
+  xSemaphoreGive(m_mutex);
+  return out.used;
+}
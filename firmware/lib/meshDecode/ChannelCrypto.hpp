@@ -0,0 +1,87 @@
+// ChannelCrypto.hpp
+#ifndef ChannelCrypto_h
+#define ChannelCrypto_h
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "mbedtls/aes.h"
+
+// Longest AES key, Meshtastic uses AES-128 or AES-256
+#define MESH_KEY_MAX 32
+// decrypt() result when no channel has the packet's channel_hash
+#define MESH_CHANNEL_NONE -1
+
+// Meshtastic channel keys, looked up by the channel_hash byte of the header.
+// Channel payloads are AES-CTR with the 16-byte initial counter block
+//   packet id (LE u64) | from (LE u32) | 0 (u32)
+// so a payload is decrypted in place in its RX ring slot. Every channel keeps
+// its expanded key in its own mbedtls context; on the ESP32-C3 mbedtls runs
+// the block cipher on the AES peripheral (CONFIG_MBEDTLS_HARDWARE_AES).
+class ChannelCrypto {
+ public:
+  struct Channel {
+    char name[12];       // Meshtastic names are at most 11 characters
+    uint8_t hash;
+    uint8_t keyLength;   // 0 for an unencrypted channel, else 16 or 32
+    uint32_t packets;
+    bool used;
+  };
+
+  struct Stats {
+    uint32_t decrypted = 0;  // Packets run through AES
+    uint32_t plain = 0;      // On a channel without encryption
+    uint32_t noKey = 0;      // channel_hash of no known channel
+    uint32_t rejected = 0;   // Hash known, but no key gave a payload the check accepted
+    uint32_t lastUs = 0;     // AES time of the last packet
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+    uint64_t airtimeUs = 0;  // Time on air of the decrypted packets
+    uint64_t bytes = 0;
+  };
+
+  // Tells a right key from a wrong one by the decrypted bytes
+  typedef bool (*PayloadCheck)(const uint8_t *data, size_t length, void *context);
+
+  ChannelCrypto();
+  ~ChannelCrypto();
+
+  // psk as Meshtastic stores it: empty or {0} = no encryption, one byte n =
+  // the default key with n - 1 added to its last byte, 16 or 32 bytes = own
+  // key (shorter keys are zero padded). Replaces a channel of the same name.
+  bool setChannel(const char *name, const uint8_t *psk, size_t pskLength);
+  bool removeChannel(const char *name);
+  void clear();
+
+  // Decrypts length bytes at payload in place with the key of channelHash.
+  // The hash is one byte, so with a check every channel carrying it is tried
+  // until one passes; a payload no key passes is left as received. Returns
+  // the channel index or MESH_CHANNEL_NONE.
+  int decrypt(uint8_t channelHash, uint32_t from, uint32_t packetId, uint8_t *payload, size_t length,
+              uint32_t airtimeUs, PayloadCheck check = nullptr, void *checkContext = nullptr);
+
+  void setEnabled(bool enabled) { m_enabled = enabled; }
+  bool isEnabled() const { return m_enabled; }
+  Stats getStats();
+  bool getChannel(size_t index, Channel &out);
+
+  // Expands psk into key, returns the key length (0, 16 or 32)
+  static size_t expandPsk(const uint8_t *psk, size_t pskLength, uint8_t *key);
+  // XOR of the name bytes and the expanded key bytes, as Meshtastic computes it
+  static uint8_t channelHash(const char *name, const uint8_t *key, size_t keyLength);
+
+ private:
+  static constexpr const char *TAG = "ChannelCrypto";
+
+  Channel m_channels[MESH_MAX_CHANNELS];
+  mbedtls_aes_context m_aes[MESH_MAX_CHANNELS];
+  Stats m_stats;
+  volatile bool m_enabled = MESH_DECRYPT_ENABLED;
+  SemaphoreHandle_t m_mutex = nullptr;  // LoRa task decrypts, serial task edits channels
+
+  int find(const char *name) const;
+};
+
+#endif
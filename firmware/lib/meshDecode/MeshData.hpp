@@ -0,0 +1,136 @@
+// MeshData.hpp
+#ifndef MeshData_h
+#define MeshData_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Meshtastic PortNum values counted separately, everything else is "other"
+#define MESH_PORT_TEXT_MESSAGE 1
+#define MESH_PORT_POSITION 3
+#define MESH_PORT_NODEINFO 4
+#define MESH_PORT_ROUTING 5
+#define MESH_PORT_ADMIN 6
+#define MESH_PORT_TEXT_MESSAGE_COMPRESSED 7
+#define MESH_PORT_WAYPOINT 8
+#define MESH_PORT_DETECTION_SENSOR 10
+#define MESH_PORT_PAXCOUNTER 34
+#define MESH_PORT_SERIAL 64
+#define MESH_PORT_STORE_FORWARD 65
+#define MESH_PORT_RANGE_TEST 66
+#define MESH_PORT_TELEMETRY 67
+#define MESH_PORT_TRACEROUTE 70
+#define MESH_PORT_NEIGHBORINFO 71
+#define MESH_PORT_ATAK_PLUGIN 72
+#define MESH_PORT_MAP_REPORT 73
+
+// What classifies a packet, read from the bytes of a decrypted
+// meshtastic_Data. The application payload is not copied, only located.
+struct MeshDataInfo {
+  uint32_t portnum = 0;
+  size_t payloadOffset = 0;  // Inside the decoded buffer
+  size_t payloadSize = 0;
+  bool wantResponse = false;
+  uint32_t requestId = 0;    // Set on replies
+  uint32_t replyId = 0;
+
+  constexpr bool isReply() const { return requestId != 0 || replyId != 0; }
+};
+
+// Walks the protobuf wire format of meshtastic_Data field by field:
+//   1 portnum (varint)   2 payload (bytes)    3 want_response (varint)
+//   4 dest (fixed32)     5 source (fixed32)   6 request_id (fixed32)
+//   7 reply_id (fixed32) 8 emoji (fixed32)    9 bitfield (varint)
+// Unknown fields are skipped by wire type. Returns false for bytes that are
+// not a well-formed message or carry no portnum, the same test Meshtastic
+// applies to find out whether a channel key was the right one.
+class MeshDataReader {
+ public:
+  static constexpr bool decode(const uint8_t *data, size_t length, MeshDataInfo &info) {
+    info = MeshDataInfo();
+    size_t pos = 0;
+    while (pos < length) {
+      uint64_t tag = 0;
+      if (!readVarint(data, length, pos, tag)) return false;
+      uint32_t field = (uint32_t)(tag >> 3);
+      uint8_t wireType = tag & 0x07;
+      if (field == 0) return false;
+
+      uint64_t value = 0;
+      switch (wireType) {
+        case WIRE_VARINT:
+          if (!readVarint(data, length, pos, value)) return false;
+          if (field == 1) info.portnum = (uint32_t)value;
+          else if (field == 3) info.wantResponse = value != 0;
+          else if (field == 2 || (field >= 4 && field <= 8)) return false;
+          break;
+        case WIRE_FIXED64:
+          if (length - pos < 8 || (field >= 1 && field <= 9)) return false;
+          pos += 8;
+          break;
+        case WIRE_LENGTH:
+          if (!readVarint(data, length, pos, value) || value > length - pos) return false;
+          if (field == 2) {
+            info.payloadOffset = pos;
+            info.payloadSize = (size_t)value;
+          } else if (field >= 1 && field <= 9) {
+            return false;
+          }
+          pos += (size_t)value;
+          break;
+        case WIRE_FIXED32:
+          if (length - pos < 4) return false;
+          value = (uint32_t)data[pos] | ((uint32_t)data[pos + 1] << 8) | ((uint32_t)data[pos + 2] << 16) |
+                  ((uint32_t)data[pos + 3] << 24);
+          pos += 4;
+          if (field == 6) info.requestId = (uint32_t)value;
+          else if (field == 7) info.replyId = (uint32_t)value;
+          else if (field <= 3 || field == 9) return false;
+          break;
+        default:  // Groups are not used by Meshtastic
+          return false;
+      }
+    }
+    return info.portnum != 0;
+  }
+
+ private:
+  static constexpr uint8_t WIRE_VARINT = 0;
+  static constexpr uint8_t WIRE_FIXED64 = 1;
+  static constexpr uint8_t WIRE_LENGTH = 2;
+  static constexpr uint8_t WIRE_FIXED32 = 5;
+
+  static constexpr bool readVarint(const uint8_t *data, size_t length, size_t &pos, uint64_t &value) {
+    value = 0;
+    for (size_t shift = 0; shift < 64 && pos < length; shift += 7) {
+      uint8_t byte = data[pos++];
+      value |= (uint64_t)(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) return true;
+    }
+    return false;  // Ran off the end or longer than 10 bytes
+  }
+};
+
+// Compile-time checks of the walker against hand-encoded messages
+namespace mesh_data_check {
+// portnum TEXT_MESSAGE, payload "hi", want_response, request_id 0x01020304
+constexpr uint8_t kText[] = {0x08, 0x01, 0x12, 0x02, 'h', 'i', 0x18, 0x01, 0x35, 0x04, 0x03, 0x02, 0x01};
+// portnum TRACEROUTE, empty payload, unknown field 15 holding a two-byte varint
+constexpr uint8_t kTrace[] = {0x08, 0x46, 0x12, 0x00, 0x78, 0x96, 0x01};
+
+constexpr MeshDataInfo decoded(const uint8_t *data, size_t length) {
+  MeshDataInfo info;
+  return MeshDataReader::decode(data, length, info) ? info : MeshDataInfo();
+}
+
+static_assert(decoded(kText, sizeof(kText)).portnum == MESH_PORT_TEXT_MESSAGE, "portnum");
+static_assert(decoded(kText, sizeof(kText)).payloadOffset == 4, "payload offset");
+static_assert(decoded(kText, sizeof(kText)).payloadSize == 2, "payload size");
+static_assert(decoded(kText, sizeof(kText)).wantResponse, "want_response");
+static_assert(decoded(kText, sizeof(kText)).requestId == 0x01020304, "request_id is little-endian fixed32");
+static_assert(decoded(kTrace, sizeof(kTrace)).portnum == MESH_PORT_TRACEROUTE, "unknown field skipped");
+static_assert(!decoded(kText, sizeof(kText) - 1).portnum, "truncated fixed32 rejected");
+static_assert(!decoded(kText + 2, sizeof(kText) - 2).portnum, "no portnum rejected");
+}  // namespace mesh_data_check
+
+#endif
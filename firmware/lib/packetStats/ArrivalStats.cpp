@@ -0,0 +1,67 @@
+// ArrivalStats.cpp
+#include "ArrivalStats.hpp"
+
+ArrivalStats::ArrivalStats() {
+  m_mutex = xSemaphoreCreateMutex();
+  clear();
+}
+
+void ArrivalStats::clear() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  memset(m_bins, 0, sizeof(m_bins));
+  m_lastRxUs = 0;
+  m_packets = 0;
+  m_minGapUs = 0;
+  m_maxGapUs = 0;
+  m_gapSumUs = 0;
+  xSemaphoreGive(m_mutex);
+}
+
+size_t ArrivalStats::bin(uint32_t gapUs) {
+  // <1 ms, then [2^(b-1), 2^b) ms
+  uint32_t ms = gapUs / 1000;
+  if (ms == 0) return 0;
+  size_t b = 32 - __builtin_clz(ms);
+  return b < ARRIVAL_HIST_BINS ? b : ARRIVAL_HIST_BINS - 1;
+}
+
+void ArrivalStats::record(int64_t rxUs, int64_t nowUs) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  // The first packet has nothing to be spaced from
+  if (m_lastRxUs != 0 && rxUs >= m_lastRxUs) {
+    int64_t spanUs = rxUs - m_lastRxUs;
+    uint32_t gapUs = spanUs > UINT32_MAX ? UINT32_MAX : (uint32_t)spanUs;
+    uint32_t latencyUs = (uint32_t)(nowUs - rxUs);
+    Bin &entry = m_bins[bin(gapUs)];
+    entry.packets++;
+    entry.latencyUs += latencyUs;
+    if (latencyUs > entry.maxLatencyUs) entry.maxLatencyUs = latencyUs;
+
+    if (m_packets == 0 || gapUs < m_minGapUs) m_minGapUs = gapUs;
+    if (gapUs > m_maxGapUs) m_maxGapUs = gapUs;
+    m_gapSumUs += gapUs;
+    m_packets++;
+  }
+  m_lastRxUs = rxUs;
+  xSemaphoreGive(m_mutex);
+}
+
+size_t ArrivalStats::write(char *out, size_t size) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  int n = snprintf(out, size, "arrival gaps=%lu min_us=%lu avg_us=%llu max_us=%lu\n", (unsigned long)m_packets,
+                   (unsigned long)m_minGapUs, (unsigned long long)(m_packets ? m_gapSumUs / m_packets : 0),
+                   (unsigned long)m_maxGapUs);
+  size_t len = (n < 0 || (size_t)n >= size) ? 0 : n;
+  for (size_t b = 0; b < ARRIVAL_HIST_BINS; b++) {
+    const Bin &entry = m_bins[b];
+    if (entry.packets == 0) continue;
+    n = snprintf(out + len, size - len, "gap from_ms=%lu pkts=%lu share=%.1f%% latency_avg_us=%llu latency_max_us=%lu\n",
+                 b == 0 ? 0UL : 1UL << (b - 1), (unsigned long)entry.packets, 100.0 * entry.packets / m_packets,
+                 (unsigned long long)(entry.latencyUs / entry.packets), (unsigned long)entry.maxLatencyUs);
+    if (n < 0 || len + n >= size) break;  // Cut at a line boundary
+    len += n;
+  }
+  out[len] = '\0';
+  xSemaphoreGive(m_mutex);
+  return len;
+}
@@ -0,0 +1,49 @@
+// ArrivalStats.hpp
+#ifndef ArrivalStats_h
+#define ArrivalStats_h
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Buffer that always holds a full write() dump
+#define ARRIVAL_TEXT_MAX (128 + ARRIVAL_HIST_BINS * 96)
+
+// Time between consecutive receptions, from the esp_timer stamps taken in the
+// DIO1 interrupt, in log2 bins from 1 ms. Each bin also keeps the IRQ to
+// consumer latency of the packets that arrived with that spacing, so a
+// receive pipeline that falls behind shows up as latency growing in the
+// short-gap bins during bursts.
+class ArrivalStats {
+ public:
+  struct Bin {
+    uint32_t packets;
+    uint64_t latencyUs;  // Sum, IRQ to dequeue
+    uint32_t maxLatencyUs;
+  };
+
+  ArrivalStats();
+
+  // rxUs is the interrupt time of the packet, nowUs the time it is dequeued
+  void record(int64_t rxUs, int64_t nowUs);
+  void clear();
+
+  // Writes an "arrival ..." summary line and one "gap ..." line per bin with
+  // packets, returns the length written
+  size_t write(char *out, size_t size);
+
+  static size_t bin(uint32_t gapUs);
+
+ private:
+  Bin m_bins[ARRIVAL_HIST_BINS];
+  int64_t m_lastRxUs = 0;
+  uint32_t m_packets = 0;
+  uint32_t m_minGapUs = 0;
+  uint32_t m_maxGapUs = 0;
+  uint64_t m_gapSumUs = 0;
+  SemaphoreHandle_t m_mutex = nullptr;  // LoRa task records, serial task dumps
+};
+
+#endif
@@ -0,0 +1,70 @@
+// DedupCache.cpp
+#include "DedupCache.hpp"
+
+DedupCache::DedupCache() { clear(); }
+
+void DedupCache::clear() {
+  memset(m_entries, 0, sizeof(m_entries));
+  m_unique = 0;
+  m_duplicates = 0;
+  m_evicted = 0;
+}
+
+uint32_t DedupCache::hash(uint32_t from, uint32_t id) {
+  // Packet ids are random, mixing in the sender separates equal ids of two nodes
+  uint32_t h = (from * 0x9E3779B1u) ^ id;
+  return h ^ (h >> 16);
+}
+
+bool DedupCache::isLive(const Entry &entry, uint32_t nowMs) const {
+  return entry.used && (nowMs - entry.firstSeenMs) < DEDUP_WINDOW_MS;
+}
+
+const DedupCache::Entry *DedupCache::checkAndInsert(uint32_t from, uint32_t id, uint8_t relayNode,
+                                                    uint8_t hopsAway, uint32_t nowMs) {
+  size_t start = hash(from, id) & (DEDUP_CACHE_SIZE - 1);
+  Entry *freeSlot = nullptr;
+  Entry *oldest = nullptr;
+
+  for (size_t i = 0; i < MAX_PROBE; i++) {
+    Entry &entry = m_entries[(start + i) & (DEDUP_CACHE_SIZE - 1)];
+    if (!isLive(entry, nowMs)) {
+      if (!freeSlot) freeSlot = &entry;
+      // Never-used slot ends the probe sequence
+      if (!entry.used) break;
+      continue;
+    }
+    if (entry.from == from && entry.id == id) {
+      if (entry.copies < UINT16_MAX) entry.copies++;
+      entry.lastRelay = relayNode;
+      if (hopsAway < entry.minHops) entry.minHops = hopsAway;
+      if (hopsAway > entry.maxHops) entry.maxHops = hopsAway;
+      m_duplicates++;
+      return &entry;
+    }
+    if (!oldest || (nowMs - entry.firstSeenMs) > (nowMs - oldest->firstSeenMs)) oldest = &entry;
+  }
+
+  Entry *slot = freeSlot;
+  if (!slot) {
+    // Probe sequence full of live packets, forget the oldest one
+    slot = oldest;
+    m_evicted++;
+  }
+  slot->from = from;
+  slot->id = id;
+  slot->firstSeenMs = nowMs;
+  slot->copies = 1;
+  slot->firstRelay = relayNode;
+  slot->lastRelay = relayNode;
+  slot->minHops = hopsAway;
+  slot->maxHops = hopsAway;
+  slot->used = true;
+  m_unique++;
+  return nullptr;
+}
+
+float DedupCache::getDedupRatio() const {
+  uint32_t total = m_unique + m_duplicates;
+  return total ? (100.0f * m_duplicates) / total : 0.0f;
+}
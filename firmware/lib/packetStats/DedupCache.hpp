@@ -0,0 +1,60 @@
+// DedupCache.hpp
+#ifndef DedupCache_h
+#define DedupCache_h
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+
+// Recently seen Meshtastic packets keyed by (from, id). Relays rebroadcast
+// the same packet several times, only the first copy should be uploaded.
+//
+// Fixed-size open-addressing table with linear probing. Entries older than
+// DEDUP_WINDOW_MS count as free, so no separate eviction pass is needed.
+class DedupCache {
+  static_assert((DEDUP_CACHE_SIZE & (DEDUP_CACHE_SIZE - 1)) == 0,
+                "DEDUP_CACHE_SIZE must be a power of two");
+
+ public:
+  struct Entry {
+    uint32_t from;
+    uint32_t id;
+    uint32_t firstSeenMs;
+    uint16_t copies;       // Times the packet was heard, first copy included
+    uint8_t firstRelay;    // relay_node of the copy that was uploaded
+    uint8_t lastRelay;
+    uint8_t minHops;
+    uint8_t maxHops;
+    bool used;
+  };
+
+  DedupCache();
+
+  // Returns the entry of an earlier copy when (from, id) is a duplicate and
+  // updates its relay/hop info. Returns nullptr and remembers the packet
+  // when it is new.
+  const Entry *checkAndInsert(uint32_t from, uint32_t id, uint8_t relayNode,
+                              uint8_t hopsAway, uint32_t nowMs);
+  void clear();
+
+  uint32_t getUnique() const { return m_unique; }
+  uint32_t getDuplicates() const { return m_duplicates; }
+  uint32_t getEvicted() const { return m_evicted; }
+  // Share of received Meshtastic packets that were duplicates, in percent
+  float getDedupRatio() const;
+
+ private:
+  static constexpr const char *TAG = "DedupCache";
+  // Longest probe sequence, the oldest entry on it is replaced when it is full
+  static constexpr size_t MAX_PROBE = 8;
+
+  Entry m_entries[DEDUP_CACHE_SIZE];
+  uint32_t m_unique = 0;
+  uint32_t m_duplicates = 0;
+  uint32_t m_evicted = 0;
+
+  static uint32_t hash(uint32_t from, uint32_t id);
+  bool isLive(const Entry &entry, uint32_t nowMs) const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+// LossTracker.cpp
+#include "LossTracker.hpp"
+
+LossTracker::LossTracker() { clear(); }
+
+void LossTracker::clear() { memset(m_senders, 0, sizeof(m_senders)); }
+
+size_t LossTracker::gapBin(uint32_t burst) {
+  if (burst <= 4) return burst - 1;
+  if (burst <= 8) return 4;
+  if (burst <= 16) return 5;
+  if (burst <= 64) return 6;
+  return 7;
+}
+
+LossTracker::SenderLoss *LossTracker::find(uint32_t key, const char *label, uint32_t nowMs) {
+  SenderLoss *freeEntry = nullptr;
+  SenderLoss *oldest = nullptr;
+  for (size_t i = 0; i < LOSS_MAX_SENDERS; i++) {
+    SenderLoss &sender = m_senders[i];
+    if (!sender.used) {
+      if (!freeEntry) freeEntry = &sender;
+      continue;
+    }
+    if (sender.key == key) return &sender;
+    if (!oldest || (nowMs - sender.lastSeenMs) > (nowMs - oldest->lastSeenMs)) oldest = &sender;
+  }
+
+  SenderLoss *entry = freeEntry ? freeEntry : oldest;
+  if (!freeEntry) {
+    ESP_LOGW(TAG, "Sender table full, forgetting %s", oldest->label);
+  }
+  memset(entry, 0, sizeof(*entry));
+  entry->key = key;
+  strncpy(entry->label, label, sizeof(entry->label) - 1);
+  return entry;
+}
+
+const LossTracker::SenderLoss *LossTracker::record(uint32_t key, const char *label, uint8_t seq, uint32_t nowMs) {
+  SenderLoss *sender = find(key, label, nowMs);
+  sender->lastSeenMs = nowMs;
+
+  if (!sender->used) {
+    // First packet from this sender, nothing to compare against yet
+    sender->used = true;
+    sender->lastSeq = seq;
+    sender->seenMask = 1;
+    sender->received = 1;
+    return sender;
+  }
+
+  uint8_t ahead = (uint8_t)(seq - sender->lastSeq);
+  if (ahead == 0) {
+    sender->duplicates++;
+  } else if (ahead < 128) {
+    // In order, possibly after a gap
+    uint32_t burst = ahead - 1;
+    if (burst > 0) {
+      sender->lost += burst;
+      sender->gapHist[gapBin(burst)]++;
+      if (burst > sender->maxBurst) sender->maxBurst = burst;
+    }
+    sender->seenMask = (ahead >= 32) ? 1 : ((sender->seenMask << ahead) | 1);
+    sender->lastSeq = seq;
+    sender->received++;
+  } else {
+    uint8_t behind = (uint8_t)(sender->lastSeq - seq);
+    if (behind < LOSS_REORDER_WINDOW) {
+      uint32_t bit = 1UL << behind;
+      if (sender->seenMask & bit) {
+        sender->duplicates++;
+      } else {
+        // Late packet already counted as lost, the gap histogram keeps the original burst
+        sender->seenMask |= bit;
+        sender->reordered++;
+        if (sender->lost > 0) sender->lost--;
+        sender->received++;
+      }
+    } else {
+      // Counter jumped back: sender rebooted, start a new sequence
+      sender->restarts++;
+      sender->lastSeq = seq;
+      sender->seenMask = 1;
+      sender->received++;
+    }
+  }
+  return sender;
+}
@@ -0,0 +1,60 @@
+// LossTracker.hpp
+#ifndef LossTracker_h
+#define LossTracker_h
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+
+// Gap histogram buckets (lost packets in one burst): 1, 2, 3, 4, 5-8, 9-16, 17-64, >64
+#define LOSS_GAP_BINS 8
+
+// Per-transmitter packet loss from the 8-bit status counter.
+// Forward jumps of less than half the counter range are losses, anything
+// within LOSS_REORDER_WINDOW behind the newest counter is a late (reordered)
+// or repeated packet, and a larger step back means the sender restarted.
+// More than 127 packets lost in a row cannot be told apart from reordering.
+class LossTracker {
+  static_assert(LOSS_REORDER_WINDOW <= 32, "Reorder window is a 32-bit mask");
+
+ public:
+  struct SenderLoss {
+    uint32_t key;
+    char label[16];
+    bool used;
+    uint8_t lastSeq;       // Newest counter seen
+    uint32_t seenMask;     // Bit n set: counter lastSeq - n was received
+    uint32_t received;
+    uint32_t lost;         // Currently missing, late arrivals are taken back out
+    uint32_t reordered;
+    uint32_t duplicates;
+    uint32_t restarts;
+    uint32_t maxBurst;
+    uint32_t gapHist[LOSS_GAP_BINS];
+    uint32_t lastSeenMs;
+
+    // Packet delivery ratio in percent
+    float pdr() const { return (received + lost) ? (100.0f * received) / (received + lost) : 100.0f; }
+  };
+
+  LossTracker();
+
+  // Records one counter value and returns the sender's entry. When the table
+  // is full the sender heard least recently is forgotten.
+  const SenderLoss *record(uint32_t key, const char *label, uint8_t seq, uint32_t nowMs);
+  void clear();
+
+  size_t size() const { return LOSS_MAX_SENDERS; }
+  const SenderLoss &at(size_t index) const { return m_senders[index]; }
+
+  static size_t gapBin(uint32_t burst);
+
+ private:
+  static constexpr const char *TAG = "LossTracker";
+
+  SenderLoss m_senders[LOSS_MAX_SENDERS];
+
+  SenderLoss *find(uint32_t key, const char *label, uint32_t nowMs);
+};
+
+#endif
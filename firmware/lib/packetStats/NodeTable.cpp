@@ -0,0 +1,166 @@
+// NodeTable.cpp
+#include "NodeTable.hpp"
+
+NodeTable::NodeTable() {
+  m_mutex = xSemaphoreCreateMutex();
+  clear();
+}
+
+void NodeTable::clear() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  memset(m_entries, 0, sizeof(m_entries));
+  m_count = 0;
+  m_evicted = 0;
+  xSemaphoreGive(m_mutex);
+}
+
+uint32_t NodeTable::hash(uint32_t id) {
+  // Meshtastic ids are MAC derived, the low bits alone cluster
+  uint32_t h = id * 0x9E3779B1u;
+  return h ^ (h >> 16);
+}
+
+size_t NodeTable::rssiBin(float rssi) {
+  // <-120, [-120,-110), ... [-80,-70), >=-70
+  int bin = (int)floorf((rssi + 130.0f) / 10.0f);
+  if (bin < 0) bin = 0;
+  if (bin >= NODE_RSSI_BINS) bin = NODE_RSSI_BINS - 1;
+  return bin;
+}
+
+size_t NodeTable::periodBin(uint32_t periodMs) {
+  // Upper bounds of the NODE_PERIOD_BINS - 1 closed bins, Meshtastic broadcast intervals fall in between
+  static const uint32_t bounds[] = {10000, 30000, 60000, 300000, 900000, 1800000, 3600000};
+  static_assert(sizeof(bounds) / sizeof(bounds[0]) == NODE_PERIOD_BINS - 1, "one bound per period bin");
+  size_t bin = 0;
+  while (bin < NODE_PERIOD_BINS - 1 && periodMs >= bounds[bin]) bin++;
+  return bin;
+}
+
+void NodeTable::update(uint32_t id, float rssi, float snr, uint8_t hopsAway, int64_t rxUs, uint32_t nowMs) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  size_t start = hash(id) & (NODE_TABLE_SIZE - 1);
+  Node *node = nullptr;
+  Node *freeSlot = nullptr;
+  Node *stalest = nullptr;
+
+  for (size_t i = 0; i < MAX_PROBE; i++) {
+    Node &entry = m_entries[(start + i) & (NODE_TABLE_SIZE - 1)];
+    if (!entry.used) {
+      freeSlot = &entry;
+      break;
+    }
+    if (entry.id == id) {
+      node = &entry;
+      break;
+    }
+    if (!stalest || (nowMs - entry.lastSeenMs) > (nowMs - stalest->lastSeenMs)) stalest = &entry;
+  }
+
+  if (!node) {
+    node = freeSlot;
+    if (node) {
+      m_count++;
+    } else {
+      ESP_LOGD(TAG, "Probe sequence full, replacing %08lX", (unsigned long)stalest->id);
+      node = stalest;
+      m_evicted++;
+    }
+    memset(node, 0, sizeof(*node));
+    node->id = id;
+    node->firstSeenMs = nowMs;
+    node->rssiEwma = rssi;
+    node->snrEwma = snr;
+    node->hopsMin = NODE_HOPS_UNKNOWN;
+    node->used = true;
+  } else {
+    node->rssiEwma += NODE_EWMA_ALPHA * (rssi - node->rssiEwma);
+    node->snrEwma += NODE_EWMA_ALPHA * (snr - node->snrEwma);
+  }
+
+  node->packets++;
+  node->lastSeenMs = nowMs;
+  uint16_t &bin = node->rssiHist[rssiBin(rssi)];
+  if (bin < UINT16_MAX) bin++;
+  if (hopsAway != NODE_HOPS_UNKNOWN) {
+    if (hopsAway < node->hopsMin) node->hopsMin = hopsAway;
+    if (hopsAway > node->hopsMax) node->hopsMax = hopsAway;
+    node->hopsSum += hopsAway;
+    if (node->hopsCount < UINT16_MAX) node->hopsCount++;
+  }
+  if (node->lastRxUs != 0 && rxUs > node->lastRxUs) {
+    uint32_t periodMs = (uint32_t)((rxUs - node->lastRxUs) / 1000);
+    if (node->periodCount == 0 || periodMs < node->periodMinMs) node->periodMinMs = periodMs;
+    if (periodMs > node->periodMaxMs) node->periodMaxMs = periodMs;
+    node->periodSumMs += periodMs;
+    node->periodCount++;
+    uint16_t &periodBinCount = node->periodHist[periodBin(periodMs)];
+    if (periodBinCount < UINT16_MAX) periodBinCount++;
+  }
+  node->lastRxUs = rxUs;
+  xSemaphoreGive(m_mutex);
+}
+
+size_t NodeTable::writeFrame(char *out, size_t size, uint32_t nowMs) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  size_t len = snprintf(out, size, "nodes %u %lu", (unsigned)m_count, (unsigned long)m_evicted);
+  char entry[128];
+
+  for (size_t i = 0; i < NODE_TABLE_SIZE && len < size; i++) {
+    const Node &node = m_entries[i];
+    if (!node.used) continue;
+    int n = snprintf(entry, sizeof(entry), ";%08lX,%lu,%lu,%lu,%.1f,%.1f,", (unsigned long)node.id,
+                     (unsigned long)node.packets, (unsigned long)((nowMs - node.firstSeenMs) / 1000),
+                     (unsigned long)((nowMs - node.lastSeenMs) / 1000), node.rssiEwma, node.snrEwma);
+    if (node.hopsCount) {
+      n += snprintf(entry + n, sizeof(entry) - n, "%u/%.1f/%u,", node.hopsMin,
+                    (float)node.hopsSum / node.hopsCount, node.hopsMax);
+    } else {
+      n += snprintf(entry + n, sizeof(entry) - n, "-,");
+    }
+    for (size_t b = 0; b < NODE_RSSI_BINS; b++) {
+      n += snprintf(entry + n, sizeof(entry) - n, "%s%u", b == 0 ? "" : ":", node.rssiHist[b]);
+    }
+    // Keep room for the newline, a node that does not fit is left out whole
+    if (len + n + 2 > size) break;
+    memcpy(out + len, entry, n);
+    len += n;
+  }
+  xSemaphoreGive(m_mutex);
+
+  if (len + 2 > size) len = size - 2;
+  out[len++] = '\n';
+  out[len] = '\0';
+  return len;
+}
+
+size_t NodeTable::writePeriods(char *out, size_t size) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  size_t len = snprintf(out, size, "periods %u", (unsigned)m_count);
+  char entry[128];
+
+  for (size_t i = 0; i < NODE_TABLE_SIZE && len < size; i++) {
+    const Node &node = m_entries[i];
+    if (!node.used) continue;
+    int n = snprintf(entry, sizeof(entry), ";%08lX,%lu,", (unsigned long)node.id, (unsigned long)node.periodCount);
+    if (node.periodCount) {
+      n += snprintf(entry + n, sizeof(entry) - n, "%.1f,%.1f,%.1f,", node.periodMinMs / 1000.0f,
+                    (float)node.periodSumMs / node.periodCount / 1000.0f, node.periodMaxMs / 1000.0f);
+    } else {
+      n += snprintf(entry + n, sizeof(entry) - n, "-,-,-,");
+    }
+    for (size_t b = 0; b < NODE_PERIOD_BINS; b++) {
+      n += snprintf(entry + n, sizeof(entry) - n, "%s%u", b == 0 ? "" : ":", node.periodHist[b]);
+    }
+    // Keep room for the newline, a node that does not fit is left out whole
+    if (len + n + 2 > size) break;
+    memcpy(out + len, entry, n);
+    len += n;
+  }
+  xSemaphoreGive(m_mutex);
+
+  if (len + 2 > size) len = size - 2;
+  out[len++] = '\n';
+  out[len] = '\0';
+  return len;
+}
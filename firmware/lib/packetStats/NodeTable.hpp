@@ -0,0 +1,77 @@
+// NodeTable.hpp
+#ifndef NodeTable_h
+#define NodeTable_h
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Hops value for packets without a Meshtastic header
+#define NODE_HOPS_UNKNOWN 0xFF
+// Buffer that always holds a full writeFrame() dump
+#define NODE_FRAME_MAX (32 + NODE_TABLE_SIZE * 128)
+
+// Nodes heard on air, keyed by 32-bit node id. Same open-addressing layout
+// as DedupCache; when a probe sequence is full the node heard least recently
+// on it is replaced, so one update costs at most MAX_PROBE slot visits.
+// Entries are never removed otherwise, so an empty slot ends a lookup.
+class NodeTable {
+  static_assert((NODE_TABLE_SIZE & (NODE_TABLE_SIZE - 1)) == 0, "NODE_TABLE_SIZE must be a power of two");
+
+ public:
+  struct Node {
+    uint32_t id;
+    uint32_t packets;
+    uint32_t firstSeenMs;
+    uint32_t lastSeenMs;
+    float rssiEwma;
+    float snrEwma;
+    uint16_t rssiHist[NODE_RSSI_BINS];
+    uint32_t hopsSum;      // Over packets with a known hop count
+    uint16_t hopsCount;
+    uint8_t hopsMin;
+    uint8_t hopsMax;
+    int64_t lastRxUs;      // esp_timer time of the last RX interrupt
+    uint32_t periodMinMs;  // Spacing of consecutive packets from this node
+    uint32_t periodMaxMs;
+    uint64_t periodSumMs;
+    uint32_t periodCount;
+    uint16_t periodHist[NODE_PERIOD_BINS];
+    bool used;
+  };
+
+  NodeTable();
+
+  // rxUs is the esp_timer stamp of the RX interrupt, it times the sender's period
+  void update(uint32_t id, float rssi, float snr, uint8_t hopsAway, int64_t rxUs, uint32_t nowMs);
+  void clear();
+
+  // Writes every node as one line:
+  //   nodes <count> <evicted>;<id>,<pkts>,<first_age_s>,<last_age_s>,<rssi>,<snr>,<hops min/avg/max>,<hist>;...
+  // Returns the length written, the frame is cut at a node boundary if out is too small.
+  size_t writeFrame(char *out, size_t size, uint32_t nowMs);
+  // Transmit period per node, same framing:
+  //   periods <count>;<id>,<periods>,<min_s>,<avg_s>,<max_s>,<hist>;...
+  size_t writePeriods(char *out, size_t size);
+
+  size_t getCount() const { return m_count; }
+  uint32_t getEvicted() const { return m_evicted; }
+
+  static size_t rssiBin(float rssi);
+  static size_t periodBin(uint32_t periodMs);
+
+ private:
+  static constexpr const char *TAG = "NodeTable";
+  static constexpr size_t MAX_PROBE = 8;
+
+  Node m_entries[NODE_TABLE_SIZE];
+  size_t m_count = 0;
+  uint32_t m_evicted = 0;
+  SemaphoreHandle_t m_mutex = nullptr;  // LoRa task updates, serial task dumps
+
+  static uint32_t hash(uint32_t id);
+};
+
+#endif
@@ -0,0 +1,92 @@
+// PortStats.cpp
+#include "PortStats.hpp"
+
+static const struct {
+  const char *name;
+  uint32_t portnum;
+} kPorts[] = {
+    {"undecoded", 0},
+    {"other", 0},
+    {"text", MESH_PORT_TEXT_MESSAGE},
+    {"position", MESH_PORT_POSITION},
+    {"nodeinfo", MESH_PORT_NODEINFO},
+    {"routing", MESH_PORT_ROUTING},
+    {"admin", MESH_PORT_ADMIN},
+    {"text_compressed", MESH_PORT_TEXT_MESSAGE_COMPRESSED},
+    {"waypoint", MESH_PORT_WAYPOINT},
+    {"detection_sensor", MESH_PORT_DETECTION_SENSOR},
+    {"paxcounter", MESH_PORT_PAXCOUNTER},
+    {"serial", MESH_PORT_SERIAL},
+    {"store_forward", MESH_PORT_STORE_FORWARD},
+    {"range_test", MESH_PORT_RANGE_TEST},
+    {"telemetry", MESH_PORT_TELEMETRY},
+    {"traceroute", MESH_PORT_TRACEROUTE},
+    {"neighborinfo", MESH_PORT_NEIGHBORINFO},
+    {"atak", MESH_PORT_ATAK_PLUGIN},
+    {"map_report", MESH_PORT_MAP_REPORT},
+};
+
+PortStats::PortStats() {
+  static_assert(sizeof(kPorts) / sizeof(kPorts[0]) == sizeof(m_entries) / sizeof(m_entries[0]),
+                "one entry per port bucket");
+  m_mutex = xSemaphoreCreateMutex();
+  clear();
+}
+
+void PortStats::clear() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  memset(m_entries, 0, sizeof(m_entries));
+  for (size_t i = 0; i < sizeof(kPorts) / sizeof(kPorts[0]); i++) {
+    m_entries[i].name = kPorts[i].name;
+    m_entries[i].portnum = kPorts[i].portnum;
+  }
+  xSemaphoreGive(m_mutex);
+}
+
+size_t PortStats::bucket(uint32_t portnum) const {
+  for (size_t i = OTHER + 1; i < sizeof(m_entries) / sizeof(m_entries[0]); i++) {
+    if (m_entries[i].portnum == portnum) return i;
+  }
+  return OTHER;
+}
+
+void PortStats::record(const MeshDataInfo &info, uint32_t airtimeUs) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  Entry &entry = m_entries[bucket(info.portnum)];
+  entry.packets++;
+  if (info.wantResponse) entry.requests++;
+  if (info.isReply()) entry.replies++;
+  entry.payloadBytes += info.payloadSize;
+  entry.airtimeUs += airtimeUs;
+  xSemaphoreGive(m_mutex);
+}
+
+void PortStats::recordUndecoded(uint32_t airtimeUs) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  m_entries[UNDECODED].packets++;
+  m_entries[UNDECODED].airtimeUs += airtimeUs;
+  xSemaphoreGive(m_mutex);
+}
+
+size_t PortStats::write(char *out, size_t size) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  uint64_t totalAirtimeUs = 0;
+  for (const Entry &entry : m_entries) totalAirtimeUs += entry.airtimeUs;
+
+  size_t len = 0;
+  out[0] = '\0';
+  for (const Entry &entry : m_entries) {
+    if (entry.packets == 0) continue;
+    int n = snprintf(out + len, size - len,
+                     "port %s pkts=%lu bytes=%llu airtime_ms=%llu share=%.1f%% requests=%lu replies=%lu\n",
+                     entry.name, (unsigned long)entry.packets, (unsigned long long)entry.payloadBytes,
+                     (unsigned long long)(entry.airtimeUs / 1000),
+                     totalAirtimeUs ? 100.0 * entry.airtimeUs / totalAirtimeUs : 0.0,
+                     (unsigned long)entry.requests, (unsigned long)entry.replies);
+    if (n < 0 || len + n >= size) break;  // Cut at a line boundary
+    len += n;
+  }
+  out[len] = '\0';
+  xSemaphoreGive(m_mutex);
+  return len;
+}
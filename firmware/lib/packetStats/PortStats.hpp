@@ -0,0 +1,51 @@
+// PortStats.hpp
+#ifndef PortStats_h
+#define PortStats_h
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+#include "../meshDecode/MeshData.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Buffer that always holds a full write() dump
+#define PORT_STATS_TEXT_MAX 2560
+
+// Traffic per Meshtastic application (portnum): packets, application
+// payload bytes and time on air, so it shows which application uses the
+// channel capacity. Packets that could not be decrypted or decoded are
+// counted in a bucket of their own, everything on ports without a bucket
+// in "other".
+class PortStats {
+ public:
+  struct Entry {
+    const char *name;
+    uint32_t portnum;
+    uint32_t packets;
+    uint32_t requests;   // want_response set
+    uint32_t replies;    // request_id or reply_id set
+    uint64_t payloadBytes;
+    uint64_t airtimeUs;
+  };
+
+  PortStats();
+
+  void record(const MeshDataInfo &info, uint32_t airtimeUs);
+  void recordUndecoded(uint32_t airtimeUs);
+  void clear();
+
+  // Writes one "port ..." line per bucket with traffic, returns the length written
+  size_t write(char *out, size_t size);
+
+ private:
+  static constexpr size_t UNDECODED = 0;
+  static constexpr size_t OTHER = 1;
+
+  Entry m_entries[19];
+  SemaphoreHandle_t m_mutex = nullptr;  // LoRa task records, serial task dumps
+
+  size_t bucket(uint32_t portnum) const;
+};
+
+#endif
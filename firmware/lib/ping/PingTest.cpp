@@ -0,0 +1,165 @@
+#include "PingTest.hpp"
+
+#include <algorithm>
+
+PingTest::PingTest(LoRaCom *loraCom, SerialCom *serialCom) : m_loraCom(loraCom), m_serialCom(serialCom) {
+  m_statsMutex = xSemaphoreCreateMutex();
+  m_loraCom->setPingEchoHandler(onEcho, this);
+}
+
+bool PingTest::start(uint32_t count, uint32_t intervalMs) {
+  if (isRunning()) {
+    ESP_LOGW(TAG, "Ping already running");
+    return false;
+  }
+  if (count == 0 || intervalMs == 0) {
+    ESP_LOGW(TAG, "Count and interval must be positive");
+    return false;
+  }
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  m_stats = PingStats();
+  m_sampleCount = 0;
+  m_count = count;
+  m_intervalMs = intervalMs;
+  m_sf = m_loraCom->getCurrentSF();
+  m_bw = m_loraCom->getCurrentBW();
+  xSemaphoreGive(m_statsMutex);
+
+  xTaskCreate(pingTaskWrapper, "PingTask", 4096, this, 1, &pingTaskHandle);
+  return true;
+}
+
+void PingTest::stop() {
+  if (pingTaskHandle != nullptr) {
+    TaskHandle_t handle = pingTaskHandle;
+    xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+    m_waitingSeq = -1;
+    pingTaskHandle = nullptr;
+    xSemaphoreGive(m_statsMutex);
+    vTaskDelete(handle);
+    ESP_LOGI(TAG, "Ping stopped");
+  }
+}
+
+void PingTest::pingTaskWrapper(void *param) {
+  static_cast<PingTest *>(param)->pingTask();
+}
+
+void PingTest::pingTask() {
+  ESP_LOGI(TAG, "Ping started: %lu probes every %lu ms at SF%d BW%.1f", (unsigned long)m_count,
+           (unsigned long)m_intervalMs, m_sf, m_bw);
+  for (uint32_t i = 0; i < m_count; i++) {
+    unsigned long startTime = millis();
+    uint16_t seq = m_seq++;
+
+    xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+    m_waitingSeq = seq;
+    xSemaphoreGive(m_statsMutex);
+    ulTaskNotifyTake(pdTRUE, 0);  // Drop a notification left by an earlier late echo
+
+    if (!m_loraCom->sendPingProbe(seq)) {
+      xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+      m_stats.sendFailed++;
+      m_waitingSeq = -1;
+      xSemaphoreGive(m_statsMutex);
+    } else {
+      bool answered = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PING_TIMEOUT_MS)) > 0;
+      xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+      m_stats.sent++;
+      if (!answered && m_waitingSeq == seq) {
+        m_stats.timeouts++;
+        ESP_LOGW(TAG, "Ping %u timed out", seq);
+      }
+      m_waitingSeq = -1;
+      xSemaphoreGive(m_statsMutex);
+    }
+
+    unsigned long elapsed = millis() - startTime;
+    if (i + 1 < m_count && elapsed < m_intervalMs) {
+      vTaskDelay(pdMS_TO_TICKS(m_intervalMs - elapsed));
+    }
+  }
+
+  printSummary();
+
+  pingTaskHandle = nullptr;
+  vTaskDelete(NULL);
+}
+
+void PingTest::onEcho(uint16_t seq, uint32_t rttUs, const RxMetadata &meta, void *context) {
+  static_cast<PingTest *>(context)->recordEcho(seq, rttUs, meta);
+}
+
+void PingTest::recordEcho(uint16_t seq, uint32_t rttUs, const RxMetadata &meta) {
+  // Radio task context: only bookkeeping here, logging is left to the ping task
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  if ((int32_t)seq != m_waitingSeq) {
+    m_stats.late++;
+    xSemaphoreGive(m_statsMutex);
+    return;
+  }
+  m_waitingSeq = -1;
+
+  PingStats &stats = m_stats;
+  if (stats.echoed > 0) {
+    float delta = fabsf((float)rttUs - (float)stats.lastRttUs);
+    stats.jitterUs += (delta - stats.jitterUs) / 16.0f;
+  }
+  if (stats.echoed == 0 || rttUs < stats.rttMinUs) stats.rttMinUs = rttUs;
+  if (rttUs > stats.rttMaxUs) stats.rttMaxUs = rttUs;
+  stats.rttSumUs += rttUs;
+  stats.lastRttUs = rttUs;
+  stats.lastRssi = meta.rssi;
+  stats.lastSnr = meta.snr;
+  stats.echoed++;
+  m_samples[m_sampleCount++ % PING_MAX_SAMPLES] = rttUs;
+  TaskHandle_t waiter = pingTaskHandle;
+  xSemaphoreGive(m_statsMutex);
+
+  if (waiter) xTaskNotifyGive(waiter);
+}
+
+void PingTest::printStatus() {
+  char buf[128];
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  sprintf(buf, "ping running=%d sent=%lu/%lu echoed=%lu last_rtt_ms=%.1f echo=%d\n", isRunning(),
+          (unsigned long)m_stats.sent, (unsigned long)m_count, (unsigned long)m_stats.echoed,
+          m_stats.lastRttUs / 1000.0f, m_loraCom->isPingEchoEnabled());
+  xSemaphoreGive(m_statsMutex);
+  m_serialCom->sendData(buf);
+}
+
+void PingTest::printSummary() {
+  PingStats stats;
+  uint32_t sorted[PING_MAX_SAMPLES];
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  stats = m_stats;
+  size_t count = std::min(m_sampleCount, (size_t)PING_MAX_SAMPLES);
+  memcpy(sorted, m_samples, count * sizeof(uint32_t));
+  xSemaphoreGive(m_statsMutex);
+
+  std::sort(sorted, sorted + count);
+  // Nearest-rank percentiles over the most recent samples
+  auto percentile = [&](uint32_t p) -> float {
+    if (count == 0) return 0;
+    size_t rank = (p * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0] / 1000.0f;
+  };
+
+  uint32_t answered = stats.sent ? stats.sent - stats.timeouts : 0;
+  float timeoutRate = stats.sent ? 100.0f * stats.timeouts / stats.sent : 0;
+  float avgMs = stats.echoed ? stats.rttSumUs / 1000.0f / stats.echoed : 0;
+  // Probe and echo are the same length, so the bare airtime is twice one probe
+  uint32_t airtimeUs = 2 * m_loraCom->getTimeOnAirUs(PING_FRAME_LEN);
+
+  char buf[256];
+  sprintf(buf,
+          "ping sf=%d bw=%.1f sent=%lu answered=%lu timeouts=%lu (%.1f%%) late=%lu send_failed=%lu "
+          "rtt_ms min/avg/max=%.1f/%.1f/%.1f p50/p90/p99=%.1f/%.1f/%.1f jitter_ms=%.2f airtime_ms=%.1f "
+          "rssi=%.0f snr=%.1f\n",
+          m_sf, m_bw, (unsigned long)stats.sent, (unsigned long)answered, (unsigned long)stats.timeouts,
+          timeoutRate, (unsigned long)stats.late, (unsigned long)stats.sendFailed, stats.rttMinUs / 1000.0f, avgMs,
+          stats.rttMaxUs / 1000.0f, percentile(50), percentile(90), percentile(99), stats.jitterUs / 1000.0f,
+          airtimeUs / 1000.0f, stats.lastRssi, stats.lastSnr);
+  m_serialCom->sendData(buf);
+}
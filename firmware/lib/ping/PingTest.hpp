@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+#include "LoRaCom.hpp"
+#include "SerialCom.hpp"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// Round-trip results of one ping run
+struct PingStats {
+  uint32_t sent = 0;
+  uint32_t echoed = 0;
+  uint32_t timeouts = 0;
+  uint32_t late = 0;        // Echoes that arrived after their timeout
+  uint32_t sendFailed = 0;  // Probes the TX queue did not take
+  uint32_t rttMinUs = 0;
+  uint32_t rttMaxUs = 0;
+  uint64_t rttSumUs = 0;
+  uint32_t lastRttUs = 0;
+  float jitterUs = 0;       // RFC 3550 interarrival jitter over consecutive RTTs
+  float lastRssi = 0;
+  float lastSnr = 0;
+};
+
+// Paired latency test: this node sends PingFrame probes one at a time and
+// the peer (ping echo enabled) returns them from its radio task. RTT covers
+// both airtimes plus the peer's turnaround, so the report also shows twice
+// the probe time on air for comparison.
+class PingTest {
+ public:
+  PingTest(LoRaCom *loraCom, SerialCom *serialCom);
+
+  bool start(uint32_t count = PING_DEFAULT_COUNT, uint32_t intervalMs = PING_PROBE_INTERVAL_MS);
+  void stop();
+  bool isRunning() const { return pingTaskHandle != nullptr; }
+
+  void printStatus();
+  void printSummary();
+
+ private:
+  static constexpr const char *TAG = "PingTest";
+
+  LoRaCom *m_loraCom;
+  SerialCom *m_serialCom;
+
+  uint32_t m_count = PING_DEFAULT_COUNT;
+  uint32_t m_intervalMs = PING_PROBE_INTERVAL_MS;
+  uint16_t m_seq = 0;
+  int32_t m_waitingSeq = -1;  // Probe the task is waiting for, guarded by m_statsMutex
+
+  PingStats m_stats;
+  uint32_t m_samples[PING_MAX_SAMPLES];  // Most recent RTTs, for percentiles
+  size_t m_sampleCount = 0;
+  uint8_t m_sf = 0;
+  float m_bw = 0;
+
+  SemaphoreHandle_t m_statsMutex = nullptr;
+  TaskHandle_t pingTaskHandle = nullptr;
+
+  static void pingTaskWrapper(void *param);
+  void pingTask();
+  static void onEcho(uint16_t seq, uint32_t rttUs, const RxMetadata &meta, void *context);
+  void recordEcho(uint16_t seq, uint32_t rttUs, const RxMetadata &meta);
+};
@@ -0,0 +1,189 @@
+#include "Survey.hpp"
+
+#include "esp_timer.h"
+
+Survey::Survey(LoRaCom *loraCom, SerialCom *serialCom) : m_loraCom(loraCom), m_serialCom(serialCom) {
+  m_statsMutex = xSemaphoreCreateMutex();
+  const SurveyPreset defaults[] = SURVEY_DEFAULT_PRESETS;
+  for (const SurveyPreset &preset : defaults) {
+    addPreset(preset);
+  }
+}
+
+bool Survey::addPreset(const SurveyPreset &preset) {
+  if (isRunning() || m_presetCount >= SURVEY_MAX_PRESETS) {
+    ESP_LOGW(TAG, "Cannot add preset (running=%d, count=%u)", isRunning(), (unsigned)m_presetCount);
+    return false;
+  }
+  m_presets[m_presetCount++] = preset;
+  return true;
+}
+
+void Survey::clearPresets() {
+  if (isRunning()) {
+    ESP_LOGW(TAG, "Cannot clear presets while the survey is running");
+    return;
+  }
+  m_presetCount = 0;
+}
+
+bool Survey::start() {
+  if (isRunning()) {
+    ESP_LOGW(TAG, "Survey already running");
+    return false;
+  }
+  if (m_presetCount == 0) {
+    ESP_LOGW(TAG, "No survey presets configured");
+    return false;
+  }
+  if (m_loraCom->isHopping()) {
+    ESP_LOGW(TAG, "Receive hopping is active, stop it first (command set hop 0)");
+    return false;
+  }
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  for (size_t i = 0; i < m_presetCount; i++) m_stats[i] = SurveyStepStats();
+  xSemaphoreGive(m_statsMutex);
+
+  m_stopRequested = false;
+
+  xTaskCreate(surveyTaskWrapper, "SurveyTask", 4096, this, 1, &surveyTaskHandle);
+  return true;
+}
+
+void Survey::stop() {
+  // The task may hold the radio or stats mutex, so it is never deleted from
+  // here: it wakes up, restores the radio and deletes itself. The stats mutex
+  // keeps the handle valid until the notification is delivered.
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  if (surveyTaskHandle != nullptr && !m_stopRequested) {
+    m_stopRequested = true;
+    xTaskNotifyGive(surveyTaskHandle);
+    ESP_LOGI(TAG, "Survey stop requested");
+  }
+  xSemaphoreGive(m_statsMutex);
+}
+
+void Survey::surveyTaskWrapper(void *param) {
+  static_cast<Survey *>(param)->surveyTask();
+}
+
+void Survey::surveyTask() {
+  // Settings to restore once every preset has been visited
+  SurveyPreset original = {m_loraCom->getCurrentFreq(), m_loraCom->getCurrentSF(), m_loraCom->getCurrentBW(),
+                           (uint8_t)m_loraCom->getCurrentCR(), m_loraCom->getSyncWord()};
+
+  ESP_LOGI(TAG, "Survey started: %u presets, %lu ms each", (unsigned)m_presetCount, (unsigned long)m_dwellMs);
+  size_t visited = 0;
+  for (size_t i = 0; i < m_presetCount && !m_stopRequested; i++) {
+    applyPreset(m_presets[i]);
+    unsigned long startTime = millis();
+    setCurrentStep(i);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(m_dwellMs));  // stop() ends the dwell early
+    setCurrentStep(-1);
+    visited++;
+
+    xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+    m_stats[i].listenMs = millis() - startTime;
+    xSemaphoreGive(m_statsMutex);
+    ESP_LOGI(TAG, "Preset %u/%u done: %lu packets", (unsigned)(i + 1), (unsigned)m_presetCount, (unsigned long)m_stats[i].packets);
+  }
+
+  applyPreset(original);
+  if (m_stopRequested) {
+    char buf[96];
+    sprintf(buf, "survey stopped after %u/%u presets, radio restored\n", (unsigned)visited,
+            (unsigned)m_presetCount);
+    m_serialCom->sendData(buf);
+  }
+  printSummary();
+
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  surveyTaskHandle = nullptr;
+  xSemaphoreGive(m_statsMutex);
+  vTaskDelete(NULL);
+}
+
+void Survey::applyPreset(const SurveyPreset &preset) {
+  ESP_LOGI(TAG, "Preset: %.3f MHz SF%d BW%.1f CR%d sync 0x%02X", preset.freqMHz, preset.sf, preset.bwKHz,
+           preset.cr, preset.syncWord);
+  m_loraCom->setFrequency(preset.freqMHz);
+  m_loraCom->setCodingRate(preset.cr);
+  m_loraCom->setSyncWord(preset.syncWord);
+  m_loraCom->setSpreadingFactor(preset.sf);
+  m_loraCom->setBandwidth(preset.bwKHz);  // Restarts receive with the new settings
+}
+
+void Survey::setCurrentStep(int step) {
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  m_currentStep = step;
+  m_stepStartUs = esp_timer_get_time();
+  xSemaphoreGive(m_statsMutex);
+}
+
+bool Survey::matchesPreset(const SurveyPreset &preset, const RxMetadata &meta) {
+  // The sync word is not reported per packet, the receive time covers presets that differ only in it
+  return meta.sf == preset.sf && fabsf(meta.bw - preset.bwKHz) < 0.01f && fabsf(meta.freqMHz - preset.freqMHz) < 0.001f;
+}
+
+size_t Survey::rssiBin(float rssi) {
+  // <-120, [-120,-110), ... [-80,-70), >=-70
+  int bin = (int)floorf((rssi + 130.0f) / 10.0f);
+  if (bin < 0) bin = 0;
+  if (bin >= SURVEY_RSSI_BINS) bin = SURVEY_RSSI_BINS - 1;
+  return bin;
+}
+
+void Survey::recordPacket(const RxMetadata &meta) {
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  int step = m_currentStep;
+  // Packets heard on the previous preset may still be queued when the step changes
+  if (step < 0 || meta.timestampUs < m_stepStartUs || !matchesPreset(m_presets[step], meta)) {
+    xSemaphoreGive(m_statsMutex);
+    return;
+  }
+  SurveyStepStats &stats = m_stats[step];
+  if (!meta.crcOk) {
+    stats.crcErrors++;
+  } else {
+    if (stats.packets == 0 || meta.rssi < stats.rssiMin) stats.rssiMin = meta.rssi;
+    if (stats.packets == 0 || meta.rssi > stats.rssiMax) stats.rssiMax = meta.rssi;
+    if (stats.packets == 0 || meta.snr < stats.snrMin) stats.snrMin = meta.snr;
+    if (stats.packets == 0 || meta.snr > stats.snrMax) stats.snrMax = meta.snr;
+    stats.rssiSum += meta.rssi;
+    stats.snrSum += meta.snr;
+    stats.rssiHist[rssiBin(meta.rssi)]++;
+    stats.packets++;
+  }
+  xSemaphoreGive(m_statsMutex);
+}
+
+void Survey::printStatus() {
+  char buf[96];
+  sprintf(buf, "survey running=%d step=%d presets=%u dwell_ms=%lu\n", isRunning(), (int)m_currentStep,
+          (unsigned)m_presetCount, (unsigned long)m_dwellMs);
+  m_serialCom->sendData(buf);
+}
+
+void Survey::printSummary() {
+  char buf[160];
+  m_serialCom->sendData("survey # freq sf bw cr sync pkts/min crc rssi_min/avg/max snr_min/avg/max hist(<-120..>=-70)\n");
+
+  xSemaphoreTake(m_statsMutex, portMAX_DELAY);
+  for (size_t i = 0; i < m_presetCount; i++) {
+    const SurveyPreset &preset = m_presets[i];
+    const SurveyStepStats &stats = m_stats[i];
+    float perMin = stats.listenMs ? stats.packets * 60000.0f / stats.listenMs : 0;
+    float rssiAvg = stats.packets ? stats.rssiSum / stats.packets : 0;
+    float snrAvg = stats.packets ? stats.snrSum / stats.packets : 0;
+    int len = sprintf(buf, "survey %u %.3f %d %.1f %d 0x%02X %lu/%.1f %lu %.0f/%.0f/%.0f %.1f/%.1f/%.1f", (unsigned)i,
+                      preset.freqMHz, preset.sf, preset.bwKHz, preset.cr, preset.syncWord,
+                      (unsigned long)stats.packets, perMin, (unsigned long)stats.crcErrors, stats.rssiMin, rssiAvg,
+                      stats.rssiMax, stats.snrMin, snrAvg, stats.snrMax);
+    for (size_t b = 0; b < SURVEY_RSSI_BINS; b++) {
+      len += sprintf(buf + len, "%c%lu", b == 0 ? ' ' : ',', (unsigned long)stats.rssiHist[b]);
+    }
+    sprintf(buf + len, "\n");
+    m_serialCom->sendData(buf);
+  }
+  xSemaphoreGive(m_statsMutex);
+}
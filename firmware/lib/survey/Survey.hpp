@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+#include "LoRaCom.hpp"
+#include "SerialCom.hpp"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// One radio configuration visited by the survey
+struct SurveyPreset {
+  float freqMHz;
+  uint8_t sf;
+  float bwKHz;
+  uint8_t cr;
+  uint8_t syncWord;
+};
+
+// What was heard while listening on one preset
+struct SurveyStepStats {
+  uint32_t packets = 0;
+  uint32_t crcErrors = 0;
+  uint32_t listenMs = 0;
+  float rssiMin = 0;
+  float rssiMax = 0;
+  float rssiSum = 0;
+  float snrMin = 0;
+  float snrMax = 0;
+  float snrSum = 0;
+  uint32_t rssiHist[SURVEY_RSSI_BINS] = {0};
+};
+
+// Unattended site survey: dwells on each preset in turn, collects packet
+// counts, RSSI/SNR distribution and CRC errors, prints a summary table and
+// puts the radio back to the settings it had before the run.
+class Survey {
+ public:
+  Survey(LoRaCom *loraCom, SerialCom *serialCom);
+
+  bool start();
+  // Asks the task to end the current dwell, restore the radio and exit
+  void stop();
+  bool isRunning() const { return surveyTaskHandle != nullptr; }
+
+  bool addPreset(const SurveyPreset &preset);
+  void clearPresets();
+  void setDwellMs(uint32_t dwellMs) { m_dwellMs = dwellMs; }
+  uint32_t getDwellMs() const { return m_dwellMs; }
+
+  // Called by the LoRa task for every packet received while running
+  void recordPacket(const RxMetadata &meta);
+
+  void printStatus();
+  void printSummary();
+
+ private:
+  static constexpr const char *TAG = "Survey";
+
+  LoRaCom *m_loraCom;
+  SerialCom *m_serialCom;
+
+  SurveyPreset m_presets[SURVEY_MAX_PRESETS];
+  SurveyStepStats m_stats[SURVEY_MAX_PRESETS];
+  size_t m_presetCount = 0;
+  uint32_t m_dwellMs = SURVEY_DWELL_MS;
+  int m_currentStep = -1;  // -1 while not listening on a preset, guarded by m_statsMutex
+  int64_t m_stepStartUs = 0;  // When the current preset was fully applied
+  volatile bool m_stopRequested = false;
+
+  SemaphoreHandle_t m_statsMutex = nullptr;
+  TaskHandle_t surveyTaskHandle = nullptr;
+
+  static void surveyTaskWrapper(void *param);
+  void surveyTask();
+  void applyPreset(const SurveyPreset &preset);
+  void setCurrentStep(int step);
+  static bool matchesPreset(const SurveyPreset &preset, const RxMetadata &meta);
+  static size_t rssiBin(float rssi);
+};
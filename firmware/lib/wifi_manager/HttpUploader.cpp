@@ -0,0 +1,270 @@
+#include "HttpUploader.hpp"
+
+HttpUploader::HttpUploader() { m_mutex = xSemaphoreCreateMutex(); }
+
+HttpUploader::~HttpUploader() {
+  closeConnection();
+  vSemaphoreDelete(m_mutex);
+}
+
+void HttpUploader::setServer(const String &host, uint16_t port) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  if (host != m_host || port != m_port) {
+    closeConnection();
+    m_host = host;
+    m_port = port;
+  }
+  xSemaphoreGive(m_mutex);
+}
+
+void HttpUploader::close() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  closeConnection();
+  xSemaphoreGive(m_mutex);
+}
+
+void HttpUploader::closeIfIdle() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  if (m_open && (millis() - m_lastUseMs >= HTTP_KEEPALIVE_IDLE_MS || !m_client.connected())) {
+    ESP_LOGI(TAG, "Closing idle connection to %s after %lu ms", m_host.c_str(), millis() - m_lastUseMs);
+    closeConnection();
+  }
+  xSemaphoreGive(m_mutex);
+}
+
+HttpUploadStats HttpUploader::getStats() {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  HttpUploadStats stats = m_stats;
+  stats.connected = m_open;
+  stats.idleMs = m_open ? millis() - m_lastUseMs : 0;
+  xSemaphoreGive(m_mutex);
+  return stats;
+}
+
+bool HttpUploader::openConnection() {
+  uint32_t startMs = millis();
+  m_client.setTimeout(SERVER_CONNECTION_TIMEOUT_MS);
+  if (!m_client.connect(m_host.c_str(), m_port)) {
+    ESP_LOGE(TAG, "Cannot connect to %s:%u", m_host.c_str(), m_port);
+    m_client.stop();
+    return false;
+  }
+  uint32_t handshakeMs = millis() - startMs;
+  m_open = true;
+  m_requestsOnConnection = 0;
+  m_rxLen = m_rxPos = 0;
+  m_stats.connects++;
+  m_stats.lastHandshakeMs = handshakeMs;
+  if (handshakeMs > m_stats.maxHandshakeMs) m_stats.maxHandshakeMs = handshakeMs;
+  m_handshakeSumMs += handshakeMs;
+  m_stats.avgHandshakeMs = m_handshakeSumMs / m_stats.connects;
+#if USE_HTTPS
+  const TlsHandshakeInfo &tls = m_client.lastHandshake();
+  if (tls.resumed) {
+    m_stats.resumedHandshakes++;
+    m_stats.lastResumedMs = handshakeMs;
+    m_resumedSumMs += handshakeMs;
+    m_stats.avgResumedMs = m_resumedSumMs / m_stats.resumedHandshakes;
+  } else {
+    m_stats.fullHandshakes++;
+    m_stats.lastFullMs = handshakeMs;
+    m_fullSumMs += handshakeMs;
+    m_stats.avgFullMs = m_fullSumMs / m_stats.fullHandshakes;
+  }
+  m_stats.tlsHeapBytes = tls.heapBytes;
+#endif
+  ESP_LOGI(TAG, "Connected to %s:%u, handshake %lu ms", m_host.c_str(), m_port, (unsigned long)handshakeMs);
+  return true;
+}
+
+void HttpUploader::closeConnection() {
+  if (m_open) m_client.stop();
+  m_open = false;
+  m_rxLen = m_rxPos = 0;
+}
+
+int HttpUploader::post(const String &path, const String &contentType, const String &body, String *head) {
+  xSemaphoreTake(m_mutex, portMAX_DELAY);
+  uint32_t startMs = millis();
+  int status = 0;
+
+  // Second attempt only when a reused connection turned out to be closed
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = m_open && m_client.connected();
+    if (!reused) {
+      closeConnection();
+      if (!openConnection()) break;
+    }
+
+    bool gotData = false;
+    bool keepAlive = false;
+    if (sendRequest(path, contentType, body)) {
+      status = readResponse(head, keepAlive, gotData);
+    }
+    if (status == 0 && reused && !gotData) {
+      // The server closed it while idle, nothing of this request was processed
+      ESP_LOGW(TAG, "Reused connection closed by the server, reconnecting");
+      m_stats.staleRetries++;
+      closeConnection();
+      continue;
+    }
+
+    if (status != 0) {
+      if (reused) m_stats.reuses++;
+      m_requestsOnConnection++;
+      m_lastUseMs = millis();
+    }
+    if (status == 0 || !keepAlive || !HTTP_KEEPALIVE || m_requestsOnConnection >= HTTP_KEEPALIVE_MAX_REQUESTS) {
+      closeConnection();
+    }
+    break;
+  }
+
+  uint32_t requestMs = millis() - startMs;
+  if (status != 0) {
+    m_stats.requests++;
+    m_stats.lastRequestMs = requestMs;
+    if (requestMs > m_stats.maxRequestMs) m_stats.maxRequestMs = requestMs;
+    m_requestSumMs += requestMs;
+    m_stats.avgRequestMs = m_requestSumMs / m_stats.requests;
+  } else {
+    m_stats.failures++;
+  }
+  xSemaphoreGive(m_mutex);
+  return status;
+}
+
+bool HttpUploader::sendRequest(const String &path, const String &contentType, const String &body) {
+  // One write for headers and body, a TLS record each instead of one per line
+  String request;
+  request.reserve(160 + path.length() + m_host.length() + contentType.length() + body.length());
+  request += "POST " + path + " HTTP/1.1\r\n";
+  request += "Host: " + m_host + "\r\n";
+  request += "User-Agent: curl/7.81.0\r\n";
+  request += "Content-Type: " + contentType + "\r\n";
+  request += "Content-Length: " + String(body.length()) + "\r\n";
+  request += HTTP_KEEPALIVE ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+  request += body;
+  ESP_LOGI(TAG, "Full HTTP request being sent:\n%s", request.c_str());  // Exactly what goes on the wire
+  size_t written = m_client.write((const uint8_t *)request.c_str(), request.length());
+  if (written != request.length()) {
+    ESP_LOGW(TAG, "Request write failed, %u of %u bytes", (unsigned)written, (unsigned)request.length());
+    return false;
+  }
+  return true;
+}
+
+int HttpUploader::readByte(uint32_t deadlineMs) {
+  if (m_rxPos == m_rxLen) {
+    int available;
+    while ((available = m_client.available()) <= 0) {
+      if (!m_client.connected() || (int32_t)(millis() - deadlineMs) >= 0) return -1;
+      delay(1);
+    }
+    int n = m_client.read(m_rxBuf, min((size_t)available, sizeof(m_rxBuf)));
+    if (n <= 0) return -1;
+    m_rxLen = n;
+    m_rxPos = 0;
+  }
+  return m_rxBuf[m_rxPos++];
+}
+
+bool HttpUploader::readLine(String &line, uint32_t deadlineMs) {
+  line = "";
+  int c;
+  while ((c = readByte(deadlineMs)) >= 0) {
+    if (c == '\n') {
+      if (line.endsWith("\r")) line.remove(line.length() - 1);
+      return true;
+    }
+    if (line.length() < 512) line += (char)c;  // Longer header lines are cut, never needed whole
+  }
+  return false;
+}
+
+bool HttpUploader::skipBytes(uint32_t count, uint32_t deadlineMs) {
+  while (count > 0) {
+    if (m_rxPos == m_rxLen) {
+      if (readByte(deadlineMs) < 0) return false;  // Refills the buffer, takes one byte of it
+      count--;
+      continue;
+    }
+    size_t take = min((size_t)count, m_rxLen - m_rxPos);
+    m_rxPos += take;
+    count -= take;
+  }
+  return true;
+}
+
+int HttpUploader::readResponse(String *head, bool &keepAlive, bool &gotData) {
+  uint32_t deadlineMs = millis() + POST_RESPONSE_TOTAL_TIMEOUT_MS;
+  String line;
+  if (!readLine(line, deadlineMs)) {
+    gotData = line.length() > 0;
+    return 0;
+  }
+  gotData = true;
+
+  // HTTP/1.1 200 OK
+  int status = 0;
+  if (line.startsWith("HTTP/1.")) status = line.substring(9, 12).toInt();
+  if (status == 0) {
+    ESP_LOGW(TAG, "Bad status line: %s", line.c_str());
+    keepAlive = false;
+    return 0;
+  }
+  keepAlive = line.startsWith("HTTP/1.1");
+  if (head) *head = line + "\n";
+
+  long contentLength = -1;
+  bool chunked = false;
+  bool headersDone = false;
+  while (readLine(line, deadlineMs)) {
+    if (line.length() == 0) {
+      headersDone = true;
+      break;
+    }
+    if (head && head->length() < 1024) *head += line + "\n";
+    int colon = line.indexOf(':');
+    if (colon < 0) continue;
+    String name = line.substring(0, colon);
+    String value = line.substring(colon + 1);
+    value.trim();
+    if (name.equalsIgnoreCase("Content-Length")) {
+      contentLength = value.toInt();
+    } else if (name.equalsIgnoreCase("Transfer-Encoding")) {
+      chunked = value.equalsIgnoreCase("chunked");
+    } else if (name.equalsIgnoreCase("Connection")) {
+      if (value.equalsIgnoreCase("close")) keepAlive = false;
+      if (value.equalsIgnoreCase("keep-alive")) keepAlive = true;
+    }
+  }
+  if (!headersDone) {
+    keepAlive = false;  // Headers cut by the timeout or the server
+    return status;
+  }
+
+  // The body is not used, but has to be read off the stream to reuse it
+  if (chunked) {
+    while (true) {
+      if (!readLine(line, deadlineMs)) {
+        keepAlive = false;
+        break;
+      }
+      uint32_t size = strtoul(line.c_str(), nullptr, 16);
+      if (size == 0) {
+        while (readLine(line, deadlineMs) && line.length() > 0) {}  // Trailers
+        break;
+      }
+      if (!skipBytes(size, deadlineMs) || !readLine(line, deadlineMs)) {
+        keepAlive = false;
+        break;
+      }
+    }
+  } else if (contentLength >= 0) {
+    if (!skipBytes(contentLength, deadlineMs)) keepAlive = false;
+  } else if (status >= 200 && status != 204 && status != 304) {
+    keepAlive = false;  // Body runs until the server closes
+  }
+  return status;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include "../lora_config.hpp"
+#if USE_HTTPS
+#include "TlsClient.hpp"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+struct HttpUploadStats {
+  bool connected = false;
+  uint32_t requests = 0;         // POSTs that got a response
+  uint32_t failures = 0;         // No connection or no response
+  uint32_t connects = 0;         // TCP + TLS handshakes
+  uint32_t reuses = 0;           // Requests sent on an already open connection
+  uint32_t staleRetries = 0;     // Reused connection found closed by the server, sent again on a new one
+  uint32_t lastHandshakeMs = 0;
+  uint32_t avgHandshakeMs = 0;
+  uint32_t maxHandshakeMs = 0;
+  uint32_t fullHandshakes = 0;     // TLS with certificate and key exchange
+  uint32_t resumedHandshakes = 0;  // TLS resumed on the cached session
+  uint32_t lastFullMs = 0;
+  uint32_t avgFullMs = 0;
+  uint32_t lastResumedMs = 0;
+  uint32_t avgResumedMs = 0;
+  int32_t tlsHeapBytes = 0;        // Heap held by the last TLS connection
+  uint32_t lastRequestMs = 0;    // Request sent until the response is read, handshake included
+  uint32_t avgRequestMs = 0;
+  uint32_t maxRequestMs = 0;
+  uint32_t idleMs = 0;           // Since the open connection was last used
+};
+
+// POST client on one long-lived HTTP/1.1 connection. The connection is
+// opened on the first request, kept while the server allows it
+// (Connection, HTTP version) and closed after HTTP_KEEPALIVE_IDLE_MS without
+// use, before the server times it out. A request that finds a reused
+// connection already closed by the server is sent once more on a new one.
+// The response is read whole (Content-Length or chunked), so the next
+// request starts on a clean stream. Over HTTPS a reconnect resumes the TLS
+// session of the previous connection when the server still has it.
+class HttpUploader {
+ public:
+  HttpUploader();
+  ~HttpUploader();
+
+  // A different server closes the open connection
+  void setServer(const String &host, uint16_t port);
+  // Returns the HTTP status code, 0 when there was no connection or response.
+  // head gets the status line and headers for logging.
+  int post(const String &path, const String &contentType, const String &body, String *head = nullptr);
+  void close();
+  // Called from the POST task between requests
+  void closeIfIdle();
+  HttpUploadStats getStats();
+
+ private:
+  static constexpr const char *TAG = "HttpUploader";
+
+#if USE_HTTPS
+  TlsClient m_client;
+#else
+  WiFiClient m_client;
+#endif
+  String m_host;
+  uint16_t m_port = 0;
+  bool m_open = false;
+  uint32_t m_requestsOnConnection = 0;
+  uint32_t m_lastUseMs = 0;
+
+  // Receive buffer, the TLS client is slow byte by byte
+  uint8_t m_rxBuf[256];
+  size_t m_rxLen = 0;
+  size_t m_rxPos = 0;
+
+  HttpUploadStats m_stats;
+  uint64_t m_handshakeSumMs = 0;
+  uint64_t m_fullSumMs = 0;
+  uint64_t m_resumedSumMs = 0;
+  uint64_t m_requestSumMs = 0;
+  SemaphoreHandle_t m_mutex = nullptr;  // HTTP task posts, serial task may post or read stats
+
+  bool openConnection();
+  void closeConnection();
+  bool sendRequest(const String &path, const String &contentType, const String &body);
+  int readResponse(String *head, bool &keepAlive, bool &gotData);
+  int readByte(uint32_t deadlineMs);
+  bool readLine(String &line, uint32_t deadlineMs);
+  bool skipBytes(uint32_t count, uint32_t deadlineMs);
+};
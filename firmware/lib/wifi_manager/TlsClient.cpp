@@ -0,0 +1,285 @@
+#include "TlsClient.hpp"
+
+#include <errno.h>
+
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+#include "mbedtls/error.h"
+#include "mbedtls/version.h"
+#if !USE_INSECURE_HTTPS
+#include "esp_crt_bundle.h"
+#endif
+#if TLS_SESSION_RTC
+#include "esp_attr.h"
+#endif
+
+// mbedtls 3 hides the context fields the handshake loop looks at
+#if MBEDTLS_VERSION_MAJOR >= 3
+#define TLS_STATE(ssl) ((ssl).MBEDTLS_PRIVATE(state))
+#else
+#define TLS_STATE(ssl) ((ssl).state)
+#endif
+
+#if TLS_SESSION_RTC
+#define TLS_RTC_MAGIC 0x544C5331u  // "TLS1"
+
+// Serialized session, survives deep sleep but not a power cycle
+struct TlsRtcSession {
+  uint32_t magic;
+  uint16_t port;
+  uint16_t length;
+  char host[64];
+  uint8_t data[TLS_SESSION_RTC_BYTES];
+};
+RTC_DATA_ATTR static TlsRtcSession s_rtcSession;
+#endif
+
+TlsClient::TlsClient() {
+  mbedtls_entropy_init(&m_entropy);
+  mbedtls_ctr_drbg_init(&m_drbg);
+  mbedtls_ssl_config_init(&m_conf);
+  mbedtls_ssl_init(&m_ssl);
+  mbedtls_net_init(&m_net);
+  mbedtls_ssl_session_init(&m_session);
+#if TLS_SESSION_RTC
+  loadSessionRtc();
+#endif
+}
+
+TlsClient::~TlsClient() {
+  stop();
+  mbedtls_ssl_session_free(&m_session);
+  mbedtls_ssl_config_free(&m_conf);
+  mbedtls_ctr_drbg_free(&m_drbg);
+  mbedtls_entropy_free(&m_entropy);
+}
+
+bool TlsClient::configure() {
+  if (m_configured) return true;
+  int ret = mbedtls_ctr_drbg_seed(&m_drbg, mbedtls_entropy_func, &m_entropy, (const unsigned char *)TAG, strlen(TAG));
+  if (ret == 0) {
+    ret = mbedtls_ssl_config_defaults(&m_conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if (ret != 0) {
+    ESP_LOGE(TAG, "TLS setup failed: -0x%04x", -ret);
+    return false;
+  }
+#if USE_INSECURE_HTTPS
+  mbedtls_ssl_conf_authmode(&m_conf, MBEDTLS_SSL_VERIFY_NONE);  // Equivalent to curl -k
+#else
+  mbedtls_ssl_conf_authmode(&m_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+  esp_crt_bundle_attach(&m_conf);
+#endif
+  mbedtls_ssl_conf_rng(&m_conf, mbedtls_ctr_drbg_random, &m_drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&m_conf, TLS_SESSION_RESUME ? MBEDTLS_SSL_SESSION_TICKETS_ENABLED
+                                                               : MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+#endif
+  m_configured = true;
+  return true;
+}
+
+int TlsClient::openSocket(const char *host, uint16_t port) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo *res = nullptr;
+  char portText[6];
+  snprintf(portText, sizeof(portText), "%u", port);
+  if (getaddrinfo(host, portText, &hints, &res) != 0 || res == nullptr) {
+    ESP_LOGE(TAG, "Cannot resolve %s", host);
+    return -1;
+  }
+
+  // Non-blocking for the whole connection, connect and handshake get a deadline
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd >= 0) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    int ret = ::connect(fd, res->ai_addr, res->ai_addrlen);
+    if (ret < 0 && errno == EINPROGRESS) {
+      fd_set writable;
+      FD_ZERO(&writable);
+      FD_SET(fd, &writable);
+      struct timeval tv = {(time_t)(m_timeoutMs / 1000), (suseconds_t)((m_timeoutMs % 1000) * 1000)};
+      int error = 0;
+      socklen_t length = sizeof(error);
+      ret = (select(fd + 1, nullptr, &writable, nullptr, &tv) > 0 &&
+             getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) ? 0 : -1;
+    }
+    if (ret < 0) {
+      close(fd);
+      fd = -1;
+    } else {
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // Requests go out in one write anyway
+    }
+  }
+  freeaddrinfo(res);
+  return fd;
+}
+
+bool TlsClient::handshake(bool &resumed) {
+  // Stepped by hand to see which way the server went: a full handshake sends
+  // its certificate after ServerHello, a resumed one goes to ChangeCipherSpec
+  bool sawCertificate = false;
+  uint32_t startMs = millis();
+  while (TLS_STATE(m_ssl) != MBEDTLS_SSL_HANDSHAKE_OVER) {
+    int ret = mbedtls_ssl_handshake_step(&m_ssl);
+    if (TLS_STATE(m_ssl) == MBEDTLS_SSL_SERVER_CERTIFICATE) sawCertificate = true;
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+      if (millis() - startMs >= m_timeoutMs) {
+        ESP_LOGE(TAG, "Handshake timeout after %lu ms", (unsigned long)m_timeoutMs);
+        return false;
+      }
+      delay(1);
+    } else if (ret != 0) {
+      char error[100];
+      mbedtls_strerror(ret, error, sizeof(error));
+      ESP_LOGE(TAG, "Handshake failed: -0x%04x %s", -ret, error);
+      return false;
+    }
+  }
+  resumed = !sawCertificate;
+  return true;
+}
+
+int TlsClient::connect(const char *host, uint16_t port) {
+  stop();
+  if (!configure()) return 0;
+  if (m_haveSession && (m_sessionHost != host || m_sessionPort != port)) forgetSession();
+
+  uint32_t heapBefore = ESP.getFreeHeap();
+  uint32_t startMs = millis();
+  m_net.fd = openSocket(host, port);
+  if (m_net.fd < 0) {
+    ESP_LOGE(TAG, "Cannot connect to %s:%u", host, port);
+    return 0;
+  }
+  int ret = mbedtls_ssl_setup(&m_ssl, &m_conf);
+  if (ret == 0) ret = mbedtls_ssl_set_hostname(&m_ssl, host);
+  if (ret == 0 && m_haveSession) ret = mbedtls_ssl_set_session(&m_ssl, &m_session);
+  if (ret != 0) {
+    ESP_LOGE(TAG, "TLS connection setup failed: -0x%04x", -ret);
+    stop();
+    return 0;
+  }
+  mbedtls_ssl_set_bio(&m_ssl, &m_net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+
+  bool resumed = false;
+  if (!handshake(resumed)) {
+    forgetSession();  // Not offered again, whatever went wrong
+    stop();
+    return 0;
+  }
+  m_connected = true;
+  m_lastHandshake.resumed = resumed;
+  m_lastHandshake.ms = millis() - startMs;
+  m_lastHandshake.heapBytes = (int32_t)(heapBefore - ESP.getFreeHeap());
+  m_sessionHost = host;
+  m_sessionPort = port;
+  saveSession();
+  ESP_LOGI(TAG, "%s handshake with %s:%u in %lu ms, %s, %ld bytes of heap", resumed ? "Resumed" : "Full", host,
+           port, (unsigned long)m_lastHandshake.ms, mbedtls_ssl_get_ciphersuite(&m_ssl),
+           (long)m_lastHandshake.heapBytes);
+  return 1;
+}
+
+void TlsClient::saveSession() {
+#if TLS_SESSION_RESUME
+  // Taken right after the handshake, a ticket the server sent is part of it
+  mbedtls_ssl_session_free(&m_session);
+  mbedtls_ssl_session_init(&m_session);
+  m_haveSession = mbedtls_ssl_get_session(&m_ssl, &m_session) == 0;
+#if TLS_SESSION_RTC
+  if (m_haveSession) storeSessionRtc();
+#endif
+#endif
+}
+
+void TlsClient::forgetSession() {
+  mbedtls_ssl_session_free(&m_session);
+  mbedtls_ssl_session_init(&m_session);
+  m_haveSession = false;
+#if TLS_SESSION_RTC
+  s_rtcSession.magic = 0;
+#endif
+}
+
+#if TLS_SESSION_RTC
+void TlsClient::storeSessionRtc() {
+  size_t length = 0;
+  s_rtcSession.magic = 0;
+  if (m_sessionHost.length() >= sizeof(s_rtcSession.host) ||
+      mbedtls_ssl_session_save(&m_session, s_rtcSession.data, sizeof(s_rtcSession.data), &length) != 0) {
+    ESP_LOGW(TAG, "Session does not fit in TLS_SESSION_RTC_BYTES, kept in RAM only");
+    return;
+  }
+  strcpy(s_rtcSession.host, m_sessionHost.c_str());
+  s_rtcSession.port = m_sessionPort;
+  s_rtcSession.length = length;
+  s_rtcSession.magic = TLS_RTC_MAGIC;
+}
+
+void TlsClient::loadSessionRtc() {
+  if (s_rtcSession.magic != TLS_RTC_MAGIC) return;
+  if (mbedtls_ssl_session_load(&m_session, s_rtcSession.data, s_rtcSession.length) == 0) {
+    m_haveSession = true;
+    m_sessionHost = s_rtcSession.host;
+    m_sessionPort = s_rtcSession.port;
+    ESP_LOGI(TAG, "TLS session for %s:%u restored from RTC memory", s_rtcSession.host, s_rtcSession.port);
+  } else {
+    forgetSession();
+  }
+}
+#endif
+
+uint8_t TlsClient::connected() {
+  if (m_connected) available();  // Notices a close from the server
+  return m_connected;
+}
+
+int TlsClient::available() {
+  if (!m_connected) return 0;
+  // Zero-length read pulls in the next record without consuming anything
+  int ret = mbedtls_ssl_read(&m_ssl, nullptr, 0);
+  if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+    m_connected = false;
+    return 0;
+  }
+  return mbedtls_ssl_get_bytes_avail(&m_ssl);
+}
+
+int TlsClient::read(uint8_t *buf, size_t size) {
+  if (!m_connected) return -1;
+  int ret = mbedtls_ssl_read(&m_ssl, buf, size);
+  if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) return 0;
+  if (ret <= 0) m_connected = false;  // 0 or an error: the server closed
+  return ret > 0 ? ret : -1;
+}
+
+size_t TlsClient::write(const uint8_t *buf, size_t size) {
+  size_t written = 0;
+  uint32_t startMs = millis();
+  while (m_connected && written < size) {
+    int ret = mbedtls_ssl_write(&m_ssl, buf + written, size - written);
+    if (ret > 0) {
+      written += ret;
+    } else if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ) {
+      if (millis() - startMs >= m_timeoutMs) break;
+      delay(1);
+    } else {
+      m_connected = false;
+    }
+  }
+  return written;
+}
+
+void TlsClient::stop() {
+  if (m_connected) mbedtls_ssl_close_notify(&m_ssl);
+  m_connected = false;
+  mbedtls_ssl_free(&m_ssl);
+  mbedtls_ssl_init(&m_ssl);
+  mbedtls_net_free(&m_net);
+  mbedtls_net_init(&m_net);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../lora_config.hpp"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/ssl.h"
+
+struct TlsHandshakeInfo {
+  bool resumed = false;   // Abbreviated handshake on the cached session
+  uint32_t ms = 0;        // TCP connect and TLS handshake
+  int32_t heapBytes = 0;  // Heap held by the connection once it is up
+};
+
+// TLS client on mbedtls that keeps the session of its last connection, ticket
+// or session ID, and offers it on the next connect so the server can resume
+// it without the certificate and key exchange. WiFiClientSecure has no way to
+// set a session between mbedtls_ssl_setup() and the handshake, hence this
+// class. Covers what HttpUploader needs of a WiFiClient.
+class TlsClient {
+ public:
+  TlsClient();
+  ~TlsClient();
+
+  void setTimeout(uint32_t timeoutMs) { m_timeoutMs = timeoutMs; }
+  // 1 when connected, as WiFiClient
+  int connect(const char *host, uint16_t port);
+  uint8_t connected();
+  int available();
+  int read(uint8_t *buf, size_t size);
+  size_t write(const uint8_t *buf, size_t size);
+  void stop();
+
+  // The next connect does a full handshake
+  void forgetSession();
+  bool hasSession() const { return m_haveSession; }
+  const TlsHandshakeInfo &lastHandshake() const { return m_lastHandshake; }
+
+ private:
+  static constexpr const char *TAG = "TlsClient";
+
+  uint32_t m_timeoutMs = SERVER_CONNECTION_TIMEOUT_MS;
+  bool m_configured = false;
+  bool m_connected = false;
+  mbedtls_entropy_context m_entropy;
+  mbedtls_ctr_drbg_context m_drbg;
+  mbedtls_ssl_config m_conf;
+  mbedtls_ssl_context m_ssl;
+  mbedtls_net_context m_net;
+
+  // Session of the last connection, for the same server only
+  mbedtls_ssl_session m_session;
+  bool m_haveSession = false;
+  String m_sessionHost;
+  uint16_t m_sessionPort = 0;
+
+  TlsHandshakeInfo m_lastHandshake;
+
+  bool configure();
+  int openSocket(const char *host, uint16_t port);
+  bool handshake(bool &resumed);
+  void saveSession();
+#if TLS_SESSION_RTC
+  void storeSessionRtc();
+  void loadSessionRtc();
+#endif
+};
@@ -353,6 +353,7 @@ bool WiFiManager::connect() {
 }
 
 void WiFiManager::disconnect() {
+  uploader.close();
   WiFi.disconnect();
   ESP_LOGI(TAG, "WiFi disconnected");
 }
@@ -491,14 +492,6 @@ void WiFiManager::stopPOSTTask() {
 }
 
 void WiFiManager::doHttpPostFromData(const String& postData) {
-#if USE_HTTPS
-  WiFiClientSecure client;
-  #if USE_INSECURE_HTTPS
-  client.setInsecure(); // Skip certificate verification (equivalent to curl -k)
-  #endif
-#else
-  WiFiClient client;
-#endif
   int port = serverPort.toInt();  // Use configurable port
   String path = serverPath.startsWith("/") ? serverPath : "/" + serverPath;
   String contentType = USE_FLASK_SERVER ? "application/json" : "application/x-www-form-urlencoded";
@@ -544,78 +537,21 @@ void WiFiManager::doHttpPostFromData(const String& postData) {
 
   // === SSL DIAGNOSTICS START ===
   ESP_LOGI(TAG, "=== SSL DIAGNOSTICS START ===");
-  ESP_LOGI(TAG, "SSL Client state: connected=%d, available=%d",
-           client.connected(), client.available());
+  HttpUploadStats connStats = uploader.getStats();
+  ESP_LOGI(TAG, "Upload connection: open=%d, idle=%lu ms, handshakes=%lu, reused=%lu",
+           connStats.connected, (unsigned long)connStats.idleMs, (unsigned long)connStats.connects,
+           (unsigned long)connStats.reuses);
   ESP_LOGI(TAG, "WiFi status: %d, local IP: %s",
            WiFi.status(), WiFi.localIP().toString().c_str());
   ESP_LOGI(TAG, "Free heap before SSL operation: %d bytes", ESP.getFreeHeap());
   ESP_LOGI(TAG, "=== SSL DIAGNOSTICS END ===");
 
-  // Log the full HTTP request being sent
-  String fullRequest = "POST " + path + " HTTP/1.1\r\n";
-  fullRequest += "Host: " + serverIP + "\r\n";
-  fullRequest += "User-Agent: curl/7.81.0\r\n";
-  fullRequest += "Content-Type: " + contentType + "\r\n";
-  fullRequest += "Content-Length: " + String(postData.length()) + "\r\n";
-  fullRequest += "Connection: close\r\n";
-  fullRequest += "\r\n";
-  fullRequest += postData;
-  ESP_LOGI(TAG, "Full HTTP request being sent:\n%s", fullRequest.c_str());
-
-  client.setTimeout(SERVER_CONNECTION_TIMEOUT_MS); // Set connection timeout
-  if (client.connect(serverIP.c_str(), port)) {
-    ESP_LOGI(TAG, "Connected to server for POST");
-    ESP_LOGI(TAG, "Sending POST headers");
-    client.println("POST " + path + " HTTP/1.1");
-    client.println("Host: " + serverIP);
-    client.println("User-Agent: curl/7.81.0");
-    client.println("Content-Type: " + contentType);
-    client.println("Content-Length: " + String(postData.length()));
-    client.println("Connection: close");
-    client.println();
-    ESP_LOGI(TAG, "Sending POST data");
-    client.println(postData);
-    ESP_LOGI(TAG, "POST data sent, client connected: %d", client.connected());
-
-    // Wait for response
-    ESP_LOGI(TAG, "Waiting for server response...");
-    delay(POST_RESPONSE_INITIAL_DELAY_MS);  // Configurable initial delay
-    String response = "";
-    unsigned long start = millis();
-    bool responseStarted = false;
-    while (client.connected() && (millis() - start < POST_RESPONSE_TOTAL_TIMEOUT_MS)) {  // Configurable total timeout
-      if (client.available()) {
-        if (!responseStarted) {
-          ESP_LOGI(TAG, "Server response started");
-          responseStarted = true;
-        }
-        int len = client.available();
-        for (int i = 0; i < len; i++) {
-          char c = client.read();
-          response += c;
-          if (response.endsWith("\r\n\r\n")) {
-            ESP_LOGI(TAG, "HTTP headers received, response length: %d", response.length());
-            break; // End of HTTP headers
-          }
-        }
-        start = millis(); // Reset timeout if data received
-      }
-      delay(10); // Yield
-    }
-
-    if (!responseStarted) {
-      ESP_LOGW(TAG, "No response received from server within timeout");
-    }
-
-    ESP_LOGI(TAG, "Response received, total length: %d", response.length());
-
-    if (response.length() == 0) {
-      ESP_LOGE(TAG, "No response data, possible server timeout or rejection");
-    }
-    if (response.length() > 0) {
-      ESP_LOGI(TAG, "Response content: %s", response.substring(0, 100).c_str());
-    }
-    client.stop();
+  // Sent on the kept-alive connection when there is one, see HttpUploader
+  uploader.setServer(serverIP, port);
+  String response;
+  int httpStatus = uploader.post(path, contentType, postData, &response);
+  if (httpStatus != 0) {
+    ESP_LOGI(TAG, "Response: HTTP %d, %s", httpStatus, response.substring(0, 100).c_str());
 
     // Calculate response time
     unsigned long responseTime = millis() - requestStartTime;
@@ -634,22 +570,22 @@ void WiFiManager::doHttpPostFromData(const String& postData) {
     }
     responseTimeCount++;
 
-    if (response.indexOf("200") >= 0) {
+    if (httpStatus == 200) {
       lastHttpResult = "Success: HTTP 200 (Queued POST sent)";
       postRequestsSent++;  // Increment successful POSTs counter
       ESP_LOGI(TAG, "Queued POST success - Total sent: %lu, received: %lu, response time: %lu ms",
                postRequestsSent, loraPacketsReceived, responseTime);
     } else {
-      lastHttpResult = "Failed: Server error";
-      ESP_LOGE(TAG, "Queued POST failed: response len=%d", response.length());
+      lastHttpResult = "Failed: Server error HTTP " + String(httpStatus);
+      ESP_LOGE(TAG, "Queued POST failed: HTTP %d", httpStatus);
       failedRequests++;
       // Return failed request to the front of queue for retry
       postQueue.insert(postQueue.begin(), postData);
       ESP_LOGW(TAG, "Request returned to queue for retry, queue size: %d", postQueue.size());
     }
   } else {
-    lastHttpResult = "Failed: Cannot connect to server " + serverIP;
-    ESP_LOGE(TAG, "Cannot connect to server %s", serverIP.c_str());
+    lastHttpResult = "Failed: No response from server " + serverIP;
+    ESP_LOGE(TAG, "No response from server %s", serverIP.c_str());
     failedRequests++;
     // Return failed request to the front of queue for retry
     postQueue.insert(postQueue.begin(), postData);
@@ -658,14 +594,6 @@ void WiFiManager::doHttpPostFromData(const String& postData) {
 }
 
 void WiFiManager::doHttpPost() {
-#if USE_HTTPS
-  WiFiClientSecure client;
-  #if USE_INSECURE_HTTPS
-  client.setInsecure(); // Skip certificate verification (equivalent to curl -k)
-  #endif
-#else
-  WiFiClient client;
-#endif
   extern unsigned long cold_counter;
   extern unsigned long hot_counter;
 
@@ -761,71 +689,12 @@ void WiFiManager::doHttpPost() {
 
   ESP_LOGI(TAG, "Connecting to server %s on port %d", serverIP.c_str(), port);
 
-  // Log the full HTTP request being sent
-  String fullRequest = "POST " + path + " HTTP/1.1\r\n";
-  fullRequest += "Host: " + serverIP + "\r\n";
-  fullRequest += "User-Agent: curl/7.81.0\r\n";
-  fullRequest += "Content-Type: " + contentType + "\r\n";
-  fullRequest += "Content-Length: " + String(postData.length()) + "\r\n";
-  fullRequest += "Connection: close\r\n";
-  fullRequest += "\r\n";
-  fullRequest += postData;
-  ESP_LOGI(TAG, "Full HTTP request being sent:\n%s", fullRequest.c_str());
-
-  if (client.connect(serverIP.c_str(), port)) {
-    client.setTimeout(3000); // Set timeout 3 seconds (optimized)
-    ESP_LOGI(TAG, "Connected to server for POST");
-    ESP_LOGI(TAG, "Sending POST headers");
-    client.println("POST " + path + " HTTP/1.1");
-    client.println("Host: " + serverIP);
-    client.println("User-Agent: curl/7.81.0");
-    client.println("Content-Type: " + contentType);
-    client.println("Content-Length: " + String(postData.length()));
-    client.println("Connection: close");
-    client.println();
-    ESP_LOGI(TAG, "Sending POST data");
-    client.println(postData);
-    ESP_LOGI(TAG, "POST data sent, client connected: %d", client.connected());
-
-    // Wait for response
-    ESP_LOGI(TAG, "Waiting for server response...");
-    delay(POST_RESPONSE_INITIAL_DELAY_MS);  // Configurable initial delay
-    String response = "";
-    unsigned long start = millis();
-    bool responseStarted = false;
-    while (client.connected() && (millis() - start < POST_RESPONSE_TOTAL_TIMEOUT_MS)) {  // Configurable total timeout
-      if (client.available()) {
-        if (!responseStarted) {
-          ESP_LOGI(TAG, "Server response started");
-          responseStarted = true;
-        }
-        int len = client.available();
-        for (int i = 0; i < len; i++) {
-          char c = client.read();
-          response += c;
-          if (response.endsWith("\r\n\r\n")) {
-            ESP_LOGI(TAG, "HTTP headers received, response length: %d", response.length());
-            break; // End of HTTP headers
-          }
-        }
-        start = millis(); // Reset timeout if data received
-      }
-      delay(10); // Yield
-    }
-
-    if (!responseStarted) {
-      ESP_LOGW(TAG, "No response received from server within timeout");
-    }
-
-    ESP_LOGI(TAG, "Response received, total length: %d", response.length());
-
-    if (response.length() == 0) {
-      ESP_LOGE(TAG, "No response data, possible server timeout or rejection");
-    }
-    if (response.length() > 0) {
-      ESP_LOGI(TAG, "Response content: %s", response.substring(0, 100).c_str());
-    }
-    client.stop();
+  // Sent on the kept-alive connection when there is one, see HttpUploader
+  uploader.setServer(serverIP, port);
+  String response;
+  int httpStatus = uploader.post(path, contentType, postData, &response);
+  if (httpStatus != 0) {
+    ESP_LOGI(TAG, "Response: HTTP %d, %s", httpStatus, response.substring(0, 100).c_str());
 
     // Calculate response time for doHttpPost() as well
     unsigned long responseTime = millis() - requestStartTime;
@@ -844,7 +713,7 @@ void WiFiManager::doHttpPost() {
     }
     responseTimeCount++;
 
-    if (response.indexOf("200") >= 0) {
+    if (httpStatus == 200) {
 #if USE_FLASK_SERVER
       lastHttpResult = "Success: HTTP 200 (Flask JSON sent: sender_nodeid=" + uint32ToHexString(last_sender_id) +
                       ", destination_nodeid=" + uint32ToHexString(last_destination_id) +
@@ -858,13 +727,13 @@ void WiFiManager::doHttpPost() {
 #endif
       hot_counter++;
     } else {
-      lastHttpResult = "Failed: Server error";
-      ESP_LOGE(TAG, "POST failed: response len=%d", response.length());
+      lastHttpResult = "Failed: Server error HTTP " + String(httpStatus);
+      ESP_LOGE(TAG, "POST failed: HTTP %d", httpStatus);
       failedRequests++;
     }
   } else {
-    lastHttpResult = "Failed: Cannot connect to server " + serverIP;
-    ESP_LOGE(TAG, "Cannot connect to server %s", serverIP.c_str());
+    lastHttpResult = "Failed: No response from server " + serverIP;
+    ESP_LOGE(TAG, "No response from server %s", serverIP.c_str());
     failedRequests++;
   }
 }
@@ -920,6 +789,7 @@ void WiFiManager::httpPostTask() {
   while (true) {
     // First, process any queued POST requests
     processPostQueue();
+    uploader.closeIfIdle();
 
     // Then handle periodic POSTs if enabled (independent of LoRa trigger mode)
     if (POST_INTERVAL_EN) {
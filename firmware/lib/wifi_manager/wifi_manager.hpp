@@ -5,6 +5,7 @@
 #include <esp_wifi.h>
 #include <vector>
 #include "../lora_config.hpp"
+#include "HttpUploader.hpp"
 
 class WiFiManager {
  public:
@@ -33,12 +34,14 @@ class WiFiManager {
   String getAPIKey() const { return apiKey; }
   String getServerURL() const { return serverProtocol + "://" + serverIP + "/" + serverPath; }
   String getLastHttpResult() const { return lastHttpResult; }
+  HttpUploadStats getUploadStats() { return uploader.getStats(); }
   String getUserId() const { return userId; }
   String getUserLocation() const { return userLocation; }
   int32_t getLastSenderId() const { return last_sender_id; }
   String getLastSenderIdHex() const;
   int32_t getLastDestinationId() const { return last_destination_id; }
   String getLastDestinationIdHex() const;
+  String uint32ToHexString(uint32_t value) const;  // Convert uint32_t to 8-character hex string
   int32_t getLastRssi() const { return loraRssi; }
   void sendSinglePost();
   void sendInitialPost();
@@ -80,7 +83,6 @@ class WiFiManager {
   void stopPingTask();
   void pingServer();
 
-  String uint32ToHexString(uint32_t value) const;  // Convert uint32_t to 8-character hex string
 
   String ssid, password;
   String apiKey, userId, userLocation;
@@ -96,6 +98,7 @@ class WiFiManager {
   TaskHandle_t httpTaskHandle = nullptr;
   TaskHandle_t pingTaskHandle = nullptr;
   String lastHttpResult = "No posts yet";
+  HttpUploader uploader;  // Kept-alive connection shared by all POSTs
 
   // POST request queue
   std::vector<String> postQueue;
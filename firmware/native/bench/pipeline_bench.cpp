@@ -0,0 +1,184 @@
+// Host benchmark of the receive pipeline: a packet trace is replayed flat out
+// through FakeRadio -> LoRaCom RX ring -> Control::loRaDataTask -> WiFiManager
+// queue, and CPU time and heap allocations per packet are reported.
+//
+//   pipeline_bench [--trace <file>] [--packets <n>] [--speed <x>]
+//
+// Without --trace a synthetic trace is generated: Meshtastic packets on the
+// default channel from a pool of nodes (a share of them relayed duplicates),
+// short and full status packets. Run under perf or a sanitizer build for
+// deeper analysis.
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <thread>
+
+#include "control.hpp"
+
+static std::atomic<uint64_t> allocCount{0};
+static std::atomic<uint64_t> allocBytes{0};
+
+void *operator new(size_t size) {
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(size, std::memory_order_relaxed);
+  void *p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static double cpuSeconds() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double wallSeconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void writeHex(FILE *f, const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) fprintf(f, "%02x", data[i]);
+  fputc('\n', f);
+}
+
+// Mix of what a receiver hears in the field, one record per line for TraceReplay
+static bool writeSyntheticTrace(const char *path, uint32_t packets) {
+  FILE *f = fopen(path, "w");
+  if (!f) return false;
+  std::mt19937 rng(42);
+  const uint32_t nodes = 24;
+  uint32_t packetId = 0x10000;
+  uint8_t statusCounter = 0;
+  uint8_t packet[255];
+  uint8_t data[128];
+  size_t dataLength = 0;
+  uint32_t lastFrom = 0;
+  ChannelCrypto crypto;
+  const uint8_t defaultPsk = 1;
+  crypto.setChannel("LongFast", &defaultPsk, 1);
+
+  fprintf(f, "# synthetic trace: %lu packets\n", (unsigned long)packets);
+  for (uint32_t i = 0; i < packets; i++) {
+    float rssi = -125.0f + (rng() % 600) / 10.0f;
+    float snr = -15.0f + (rng() % 250) / 10.0f;
+    uint32_t kind = rng() % 10;
+    fprintf(f, "%u %.1f %.2f ", (unsigned)(50 + rng() % 200), rssi, snr);
+
+    if (kind == 0) {
+      char status[7];
+      snprintf(status, sizeof(status), "%02X%04X", statusCounter++, 0xE5F6);
+      writeHex(f, (const uint8_t *)status, 6);
+    } else if (kind == 1) {
+      char status[80];
+      int n = snprintf(status, sizeof(status), "st ID:bench R:%d B:100.00 M:transceive S:ok N:%02X", (int)rssi,
+                       statusCounter++);
+      writeHex(f, (const uint8_t *)status, n);
+    } else {
+      // One Meshtastic packet in eight repeats the previous one, as a relay would
+      bool duplicate = (kind == 2 && packetId > 0x10000);
+      if (!duplicate) {
+        lastFrom = 0xA0000000 + (rng() % nodes);
+        // meshtastic_Data: portnum, payload, want_response on some
+        static const uint8_t ports[] = {1, 3, 3, 4, 5, 67, 67, 70};
+        size_t payload = 10 + rng() % 60;
+        dataLength = 0;
+        data[dataLength++] = 0x08;
+        data[dataLength++] = ports[rng() % sizeof(ports)];
+        data[dataLength++] = 0x12;
+        data[dataLength++] = payload;
+        for (size_t b = 0; b < payload; b++) data[dataLength++] = rng() & 0xFF;
+        if (rng() % 4 == 0) {
+          data[dataLength++] = 0x18;
+          data[dataLength++] = 0x01;
+        }
+        // CTR decryption is the encryption
+        crypto.decrypt(0x08, lastFrom, packetId, data, dataLength, 0);
+        packetId++;
+      }
+      uint32_t id = packetId - 1;
+      uint32_t to = 0xFFFFFFFF;
+      memcpy(packet, &to, 4);
+      memcpy(packet + 4, &lastFrom, 4);
+      memcpy(packet + 8, &id, 4);
+      packet[12] = duplicate ? 0x62 : 0x63;  // hop_limit 3 (2 after a relay), hop_start 3
+      packet[13] = 0x08;                     // LongFast, default key
+      packet[14] = 0;
+      packet[15] = duplicate ? (rng() & 0xFF) : 0;
+      memcpy(packet + 16, data, dataLength);
+      writeHex(f, packet, 16 + dataLength);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *tracePath = nullptr;
+  uint32_t packets = 20000;
+  float speed = 0;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--trace")) tracePath = argv[i + 1];
+    else if (!strcmp(argv[i], "--packets")) packets = strtoul(argv[i + 1], nullptr, 10);
+    else if (!strcmp(argv[i], "--speed")) speed = atof(argv[i + 1]);
+  }
+  if (!tracePath) {
+    tracePath = "bench_trace.txt";
+    if (!writeSyntheticTrace(tracePath, packets)) {
+      fprintf(stderr, "Cannot write %s\n", tracePath);
+      return 1;
+    }
+  }
+
+  Control *control = new Control();
+  control->setup();
+  control->begin();
+  control->setStatusEnabled(false);  // Only replayed traffic is measured
+  LoRaCom *lora = control->getLoRaCom();
+
+  // Idle cost of the background tasks, subtracted from the run below
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  double idleCpu = cpuSeconds();
+  double idleWall = wallSeconds();
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  double idleCpuPerSec = (cpuSeconds() - idleCpu) / (wallSeconds() - idleWall);
+
+  uint64_t allocs0 = allocCount.load();
+  uint64_t bytes0 = allocBytes.load();
+  uint32_t dropped0 = lora->getRxRingDropped();
+  double cpu0 = cpuSeconds();
+  double wall0 = wallSeconds();
+
+  if (!lora->startReplay(tracePath, speed, false)) return 1;
+  // Ring empty after the replay ended: the last packet has been released by the consumer
+  while (lora->isReplaying() || lora->getRxRingUsed() > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+
+  double wall = wallSeconds() - wall0;
+  double cpu = cpuSeconds() - cpu0;
+  uint32_t played = lora->getReplayPlayed();
+  uint32_t dropped = lora->getRxRingDropped() - dropped0;
+  uint64_t allocs = allocCount.load() - allocs0;
+  uint64_t bytes = allocBytes.load() - bytes0;
+  double cpuPacket = played ? (cpu - idleCpuPerSec * wall) / played : 0;
+
+  printf("packets=%lu dropped=%lu bad_lines=%lu wall_s=%.3f rate_pps=%.0f\n", (unsigned long)played,
+         (unsigned long)dropped, (unsigned long)lora->getReplayBadLines(), wall, played / wall);
+  printf("cpu_us_per_packet=%.2f (raw %.2f, idle %.3f cpu/s) allocs_per_packet=%.2f bytes_per_packet=%.0f\n",
+         cpuPacket * 1e6, played ? cpu / played * 1e6 : 0, idleCpuPerSec, played ? (double)allocs / played : 0,
+         played ? (double)bytes / played : 0);
+  fflush(stdout);
+  // Firmware tasks never return, leave without running static destructors under them
+  std::_Exit(0);
+}
@@ -0,0 +1,12 @@
+// Entry point of the host build, the Arduino core does this on the board
+#include <stdio.h>
+
+void setup();
+void loop();
+
+int main() {
+  // Serial output is stdout, keep it line by line when piped like the UART
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  setup();
+  while (true) loop();
+}
@@ -0,0 +1,177 @@
+#pragma once
+// Host shim of the Arduino-ESP32 core surface used by lib/
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+void yield();
+
+class String {
+ public:
+  String() {}
+  String(const char *s) : s_(s ? s : "") {}
+  String(const std::string &s) : s_(s) {}
+  String(char c) : s_(1, c) {}
+  String(int v) : s_(std::to_string(v)) {}
+  String(unsigned int v) : s_(std::to_string(v)) {}
+  String(long v) : s_(std::to_string(v)) {}
+  String(unsigned long v) : s_(std::to_string(v)) {}
+  String(long long v) : s_(std::to_string(v)) {}
+  String(unsigned long long v) : s_(std::to_string(v)) {}
+  String(float v, unsigned int decimals = 2) { fmt(v, decimals); }
+  String(double v, unsigned int decimals = 2) { fmt(v, decimals); }
+
+  const char *c_str() const { return s_.c_str(); }
+  unsigned int length() const { return s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  char operator[](unsigned int i) const { return s_[i]; }
+  char charAt(unsigned int i) const { return s_[i]; }
+  bool reserve(unsigned int n) { s_.reserve(n); return true; }
+
+  String &operator+=(const String &o) { s_ += o.s_; return *this; }
+  String &operator+=(const char *o) { s_ += o; return *this; }
+  String &operator+=(char c) { s_ += c; return *this; }
+  String &operator+=(int v) { s_ += std::to_string(v); return *this; }
+  String &operator+=(unsigned long v) { s_ += std::to_string(v); return *this; }
+  bool concat(const char *o, unsigned int n) { s_.append(o, n); return true; }
+  friend String operator+(const String &a, const String &b) { return String(a.s_ + b.s_); }
+  friend String operator+(const String &a, const char *b) { return String(a.s_ + b); }
+  friend String operator+(const char *a, const String &b) { return String(a + b.s_); }
+  friend String operator+(const String &a, char b) { return String(a.s_ + b); }
+  bool operator==(const String &o) const { return s_ == o.s_; }
+  bool operator==(const char *o) const { return s_ == o; }
+  bool operator!=(const String &o) const { return s_ != o.s_; }
+  bool equals(const String &o) const { return s_ == o.s_; }
+
+  bool startsWith(const String &p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String &p) const {
+    return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+  }
+  int indexOf(const String &p, unsigned int from = 0) const { auto r = s_.find(p.s_, from); return r == std::string::npos ? -1 : (int)r; }
+  int indexOf(char c, unsigned int from = 0) const { auto r = s_.find(c, from); return r == std::string::npos ? -1 : (int)r; }
+  int lastIndexOf(char c) const { auto r = s_.rfind(c); return r == std::string::npos ? -1 : (int)r; }
+  String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > s_.size()) return String();
+    return String(s_.substr(from, std::min<size_t>(to, s_.size()) - from));
+  }
+  void replace(const String &a, const String &b) {
+    size_t pos = 0;
+    while (!a.s_.empty() && (pos = s_.find(a.s_, pos)) != std::string::npos) {
+      s_.replace(pos, a.s_.size(), b.s_);
+      pos += b.s_.size();
+    }
+  }
+  void trim() {
+    size_t b = s_.find_first_not_of(" \t\r\n");
+    size_t e = s_.find_last_not_of(" \t\r\n");
+    s_ = (b == std::string::npos) ? std::string() : s_.substr(b, e - b + 1);
+  }
+  void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+  bool equalsIgnoreCase(const String &o) const { return strcasecmp(s_.c_str(), o.s_.c_str()) == 0; }
+  long toInt() const { return atol(s_.c_str()); }
+  float toFloat() const { return atof(s_.c_str()); }
+
+ private:
+  void fmt(double v, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    s_ = buf;
+  }
+  std::string s_;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buf++);
+    return n;
+  }
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return print(String(v)); }
+  size_t print(unsigned long v) { return print(String(v)); }
+  size_t println() { return write("\r\n"); }
+  size_t println(const char *s) { return print(s) + println(); }
+  size_t println(const String &s) { return print(s) + println(); }
+  size_t printf(const char *format, ...);
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() { return -1; }
+  void setTimeout(unsigned long ms) { timeout_ = ms; }
+  size_t readBytes(uint8_t *buf, size_t len) {
+    size_t n = 0;
+    while (n < len) {
+      int c = read();
+      if (c < 0) break;
+      buf[n++] = (uint8_t)c;
+    }
+    return n;
+  }
+  String readStringUntil(char terminator) {
+    String out;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) out += (char)c;
+    return out;
+  }
+  String readString() { return readStringUntil('\0'); }
+
+ protected:
+  unsigned long timeout_ = 1000;
+};
+
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long) {}
+  int available() override;
+  int read() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+class IPAddress {
+ public:
+  String toString() const { return String("127.0.0.1"); }
+};
+
+class EspClass {
+ public:
+  uint32_t getFreeHeap() { return 256 * 1024; }
+  uint32_t getMinFreeHeap() { return 200 * 1024; }
+  uint64_t getEfuseMac() { return 0xF6E5D4C3B2A1ULL; }  // A1:B2:C3:D4:E5:F6
+};
+extern EspClass ESP;
@@ -0,0 +1,51 @@
+#pragma once
+// Host shim of LittleFS backed by a directory (NATIVE_LITTLEFS_ROOT, default ./littlefs)
+#include <cstdio>
+#include <memory>
+
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+ public:
+  File() {}
+  explicit File(FILE *f) : f_(f, &fclose) {}
+  operator bool() const { return (bool)f_; }
+  int available() override;
+  int read() override;
+  size_t read(uint8_t *buf, size_t size) { return f_ ? fread(buf, 1, size, f_.get()) : 0; }
+  using Print::write;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override { return f_ ? fwrite(buf, 1, size, f_.get()) : 0; }
+  bool seek(uint32_t pos, SeekMode mode = SeekSet) { return f_ && fseek(f_.get(), pos, (int)mode) == 0; }
+  size_t position() const { return f_ ? ftell(f_.get()) : 0; }
+  size_t size() const;
+  void flush() override { if (f_) fflush(f_.get()); }
+  void close() { f_.reset(); }
+
+ private:
+  std::shared_ptr<FILE> f_;
+};
+
+class LittleFSFS {
+ public:
+  bool begin(bool formatOnFail = false);
+  void end() {}
+  bool format() { return true; }
+  size_t totalBytes() { return 1024 * 1024; }
+  size_t usedBytes();
+  bool exists(const char *path);
+  bool exists(const String &path) { return exists(path.c_str()); }
+  File open(const char *path, const char *mode = FILE_READ);
+  File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+  bool remove(const char *path);
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool mkdir(const char *path);
+  bool mkdir(const String &path) { return mkdir(path.c_str()); }
+};
+extern LittleFSFS LittleFS;
@@ -0,0 +1,90 @@
+#pragma once
+// Host shim of the RadioLib surface used by lib/. The SX126x stub never finds
+// a chip, so host builds always run on the fake radio backend.
+#include <cstddef>
+#include <cstdint>
+
+#include "SPI.h"
+
+#define RADIOLIB_ERR_NONE (0)
+#define RADIOLIB_ERR_UNKNOWN (-1)
+#define RADIOLIB_ERR_CHIP_NOT_FOUND (-2)
+#define RADIOLIB_ERR_PACKET_TOO_LONG (-4)
+#define RADIOLIB_ERR_RX_TIMEOUT (-6)
+#define RADIOLIB_ERR_CRC_MISMATCH (-7)
+#define RADIOLIB_PREAMBLE_DETECTED (-14)
+#define RADIOLIB_CHANNEL_FREE (-15)
+#define RADIOLIB_LORA_DETECTED (-702)
+
+#define RADIOLIB_SX126X_MAX_PACKET_LENGTH (255U)
+#define RADIOLIB_SX126X_RX_TIMEOUT_INF (0xFFFFFFUL)
+
+typedef uint32_t RadioLibIrqFlags_t;
+enum RadioLibIrqType_t {
+  RADIOLIB_IRQ_TX_DONE = 0x00,
+  RADIOLIB_IRQ_RX_DONE,
+  RADIOLIB_IRQ_PREAMBLE_DETECTED,
+  RADIOLIB_IRQ_SYNC_WORD_VALID,
+  RADIOLIB_IRQ_HEADER_VALID,
+  RADIOLIB_IRQ_HEADER_ERR,
+  RADIOLIB_IRQ_CRC_ERR,
+  RADIOLIB_IRQ_CAD_DONE,
+  RADIOLIB_IRQ_CAD_DETECTED,
+  RADIOLIB_IRQ_TIMEOUT,
+  RADIOLIB_IRQ_NOT_SUPPORTED = 0x1F,
+};
+#define RADIOLIB_IRQ_RX_DEFAULT_FLAGS ((1UL << RADIOLIB_IRQ_RX_DONE) | (1UL << RADIOLIB_IRQ_TIMEOUT) | (1UL << RADIOLIB_IRQ_CRC_ERR) | (1UL << RADIOLIB_IRQ_HEADER_VALID) | (1UL << RADIOLIB_IRQ_HEADER_ERR))
+#define RADIOLIB_IRQ_RX_DEFAULT_MASK ((1UL << RADIOLIB_IRQ_RX_DONE))
+
+class Module {
+ public:
+  Module(uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio = 0xFFFFFFFF) {}
+};
+
+class SX126x {
+ public:
+  explicit SX126x(Module *mod) {}
+  int16_t begin(float freq = 434.0, float bw = 125.0, uint8_t sf = 9, uint8_t cr = 7,
+                uint8_t syncWord = 0x12, int8_t power = 10, uint16_t preambleLength = 8,
+                float tcxoVoltage = 1.6, bool useRegulatorLDO = false) { return RADIOLIB_ERR_CHIP_NOT_FOUND; }
+  int16_t startTransmit(const char *str, uint8_t addr = 0) { return RADIOLIB_ERR_UNKNOWN; }
+  int16_t startTransmit(const uint8_t *data, size_t len, uint8_t addr = 0) { return RADIOLIB_ERR_UNKNOWN; }
+  int16_t finishTransmit() { return RADIOLIB_ERR_NONE; }
+  int16_t startReceive() { return RADIOLIB_ERR_NONE; }
+  int16_t startReceive(uint32_t timeout, RadioLibIrqFlags_t irqFlags = RADIOLIB_IRQ_RX_DEFAULT_FLAGS,
+                       RadioLibIrqFlags_t irqMask = RADIOLIB_IRQ_RX_DEFAULT_MASK, size_t len = 0) { return RADIOLIB_ERR_NONE; }
+  int16_t startReceiveDutyCycleAuto(uint16_t senderPreambleLength = 0, uint16_t minSymbols = 8,
+                                    RadioLibIrqFlags_t irqFlags = RADIOLIB_IRQ_RX_DEFAULT_FLAGS,
+                                    RadioLibIrqFlags_t irqMask = RADIOLIB_IRQ_RX_DEFAULT_MASK) { return RADIOLIB_ERR_NONE; }
+  int16_t readData(uint8_t *data, size_t len) { return RADIOLIB_ERR_NONE; }
+  size_t getPacketLength(bool update = true) { return 0; }
+  float getRSSI(bool packet = true) { return -120.0f; }
+  float getSNR() { return 0.0f; }
+  float getFrequencyError(bool autoCorrect = false) { return 0.0f; }
+  int16_t scanChannel() { return RADIOLIB_CHANNEL_FREE; }
+  uint32_t getIrqFlags() { return 0; }
+  bool checkIrq(RadioLibIrqType_t irq) { return false; }
+  int16_t standby() { return RADIOLIB_ERR_NONE; }
+  int16_t setOutputPower(int8_t power) { return RADIOLIB_ERR_NONE; }
+  int16_t setFrequency(float freq) { return RADIOLIB_ERR_NONE; }
+  int16_t setSpreadingFactor(uint8_t sf) { return RADIOLIB_ERR_NONE; }
+  int16_t setBandwidth(float bw) { return RADIOLIB_ERR_NONE; }
+  int16_t setCodingRate(uint8_t cr, bool longInterleave = false) { return RADIOLIB_ERR_NONE; }
+  int16_t setSyncWord(uint8_t syncWord, uint8_t controlBits = 0x44) { return RADIOLIB_ERR_NONE; }
+  int16_t setPreambleLength(size_t preambleLength) { return RADIOLIB_ERR_NONE; }
+  int16_t setDio2AsRfSwitch(bool enable = true) { return RADIOLIB_ERR_NONE; }
+  void setPacketReceivedAction(void (*func)(void)) {}
+  void clearPacketReceivedAction() {}
+  void setDio1Action(void (*func)(void)) {}
+  void clearDio1Action() {}
+};
+
+class SX1262 : public SX126x {
+ public:
+  explicit SX1262(Module *mod) : SX126x(mod) {}
+};
+
+class SX1268 : public SX126x {
+ public:
+  explicit SX1268(Module *mod) : SX126x(mod) {}
+};
@@ -0,0 +1,64 @@
+#pragma once
+// Host shim of the Arduino-ESP32 WiFi surface. The station never associates,
+// so uploads stay queued and the payload/queue logic can be measured offline.
+#include "Arduino.h"
+
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_DISCONNECTED = 6 } wl_status_t;
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1 } wifi_mode_t;
+typedef enum {
+  WIFI_AUTH_OPEN = 0, WIFI_AUTH_WEP, WIFI_AUTH_WPA_PSK, WIFI_AUTH_WPA2_PSK,
+  WIFI_AUTH_WPA_WPA2_PSK, WIFI_AUTH_WPA2_ENTERPRISE, WIFI_AUTH_WPA3_PSK
+} wifi_auth_mode_t;
+typedef enum {
+  WIFI_POWER_20dBm = 78, WIFI_POWER_19_5dBm = 76, WIFI_POWER_19dBm = 74, WIFI_POWER_18_5dBm = 72,
+  WIFI_POWER_18dBm = 70, WIFI_POWER_15dBm = 60, WIFI_POWER_10dBm = 40, WIFI_POWER_8_5dBm = 34,
+  WIFI_POWER_2dBm = 8
+} wifi_power_t;
+typedef enum { SYSTEM_EVENT_STA_DISCONNECTED = 5 } WiFiEvent_t;
+
+class Client : public Stream {
+ public:
+  virtual int connect(const char *host, uint16_t port) = 0;
+  virtual uint8_t connected() = 0;
+  virtual void stop() = 0;
+  virtual int read(uint8_t *buf, size_t size) = 0;
+  using Stream::read;
+  using Print::write;
+  virtual operator bool() { return connected(); }
+};
+
+class WiFiClient : public Client {
+ public:
+  int connect(const char *host, uint16_t port) override { return 0; }
+  uint8_t connected() override { return 0; }
+  void stop() override {}
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int read(uint8_t *buf, size_t size) override { return -1; }
+  size_t write(uint8_t c) override { return 0; }
+  size_t write(const uint8_t *buf, size_t size) override { return 0; }
+  void setNoDelay(bool) {}
+  int fd() const { return -1; }
+};
+
+class WiFiClass {
+ public:
+  bool mode(wifi_mode_t) { return true; }
+  wl_status_t status() { return WL_DISCONNECTED; }
+  wl_status_t begin(const char *ssid, const char *pass) { return WL_DISCONNECTED; }
+  bool disconnect(bool wifioff = false) { return true; }
+  bool reconnect() { return false; }
+  bool setAutoReconnect(bool) { return true; }
+  bool setSleep(bool) { return true; }
+  void persistent(bool) {}
+  void onEvent(void (*cb)(WiFiEvent_t)) {}
+  bool setTxPower(wifi_power_t) { return true; }
+  uint8_t *macAddress(uint8_t *mac) { for (int i = 0; i < 6; i++) mac[i] = 0x10 + i; return mac; }
+  IPAddress localIP() { return IPAddress(); }
+  int16_t scanNetworks() { return 0; }
+  wifi_auth_mode_t encryptionType(uint8_t) { return WIFI_AUTH_OPEN; }
+  int32_t channel(uint8_t) { return 1; }
+  String SSID(uint8_t) { return String(); }
+  int32_t RSSI(uint8_t) { return 0; }
+};
+extern WiFiClass WiFi;
@@ -0,0 +1,3 @@
+// Host shim, no RTC memory on the host
+#pragma once
+#define RTC_DATA_ATTR
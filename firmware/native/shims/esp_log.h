@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdio>
+
+#ifndef NATIVE_LOG_LEVEL
+#define NATIVE_LOG_LEVEL 2  // 1=E, 2=W, 3=I, 4=D
+#endif
+
+#define NATIVE_LOG(lvl, letter, tag, format, ...) \
+  do { if (NATIVE_LOG_LEVEL >= lvl) fprintf(stderr, letter " (%s) " format "\n", tag, ##__VA_ARGS__); } while (0)
+
+#define ESP_LOGE(tag, format, ...) NATIVE_LOG(1, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) NATIVE_LOG(2, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) NATIVE_LOG(3, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) NATIVE_LOG(4, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) NATIVE_LOG(5, "V", tag, format, ##__VA_ARGS__)
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+typedef enum { WIFI_SECOND_CHAN_NONE = 0, WIFI_SECOND_CHAN_ABOVE, WIFI_SECOND_CHAN_BELOW } wifi_second_chan_t;
+inline esp_err_t esp_wifi_get_channel(uint8_t *primary, wifi_second_chan_t *second) { return ESP_OK; }
+typedef enum { ESP_MAC_WIFI_STA = 0 } esp_mac_type_t;
+inline esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type) { for (int i = 0; i < 6; i++) mac[i] = 0; return ESP_OK; }
+inline esp_err_t esp_base_mac_addr_set(const uint8_t *mac) { return ESP_OK; }
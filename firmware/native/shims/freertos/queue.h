@@ -0,0 +1,14 @@
+#pragma once
+#include "FreeRTOS.h"
+
+struct NativeQueue;
+typedef NativeQueue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t q);
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticksToWait);
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q);
@@ -0,0 +1,13 @@
+#pragma once
+#include "FreeRTOS.h"
+
+struct NativeMutex;
+typedef NativeMutex *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t m, TickType_t ticksToWait);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t m);
+void vSemaphoreDelete(SemaphoreHandle_t m);
@@ -0,0 +1,3 @@
+// Host shim, lwIP keeps getaddrinfo()
+#pragma once
+#include <netdb.h>
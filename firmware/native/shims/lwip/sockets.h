@@ -0,0 +1,8 @@
+// Host shim, lwIP keeps the BSD socket API
+#pragma once
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
@@ -0,0 +1,16 @@
+// Host shim of the mbedtls AES API the firmware uses, backed by OpenSSL
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#define MBEDTLS_ERR_AES_INVALID_KEY_LENGTH -0x0020
+
+struct mbedtls_aes_context {
+  alignas(16) unsigned char key[256];  // OpenSSL AES_KEY
+};
+
+void mbedtls_aes_init(mbedtls_aes_context *ctx);
+void mbedtls_aes_free(mbedtls_aes_context *ctx);
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits);
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length, size_t *nc_off, unsigned char nonce_counter[16],
+                          unsigned char stream_block[16], const unsigned char *input, unsigned char *output);
@@ -0,0 +1,11 @@
+// Host shim of the mbedtls entropy API TlsClient uses
+#pragma once
+#include <cstddef>
+
+struct mbedtls_entropy_context {
+  int unused;
+};
+
+void mbedtls_entropy_init(mbedtls_entropy_context *ctx);
+void mbedtls_entropy_free(mbedtls_entropy_context *ctx);
+int mbedtls_entropy_func(void *data, unsigned char *output, size_t len);
@@ -0,0 +1,5 @@
+// Host shim of mbedtls_strerror
+#pragma once
+#include <cstddef>
+
+void mbedtls_strerror(int errnum, char *buffer, size_t buflen);
@@ -0,0 +1,12 @@
+// Host shim of the mbedtls socket BIO, no network on the host
+#pragma once
+#include <cstddef>
+
+struct mbedtls_net_context {
+  int fd;
+};
+
+void mbedtls_net_init(mbedtls_net_context *ctx);
+void mbedtls_net_free(mbedtls_net_context *ctx);
+int mbedtls_net_send(void *ctx, const unsigned char *buf, size_t len);
+int mbedtls_net_recv(void *ctx, unsigned char *buf, size_t len);
@@ -0,0 +1,84 @@
+// Host shim of the mbedtls TLS client API TlsClient uses. There is no network
+// on the host, the handshake always fails as WiFiClient::connect() does.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+#define MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE -0x7080
+#define MBEDTLS_ERR_SSL_BAD_INPUT_DATA -0x7100
+#define MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY -0x7880
+#define MBEDTLS_ERR_SSL_WANT_READ -0x6900
+#define MBEDTLS_ERR_SSL_WANT_WRITE -0x6880
+
+#define MBEDTLS_SSL_IS_CLIENT 0
+#define MBEDTLS_SSL_TRANSPORT_STREAM 0
+#define MBEDTLS_SSL_PRESET_DEFAULT 0
+#define MBEDTLS_SSL_VERIFY_NONE 0
+#define MBEDTLS_SSL_VERIFY_REQUIRED 2
+#define MBEDTLS_SSL_SESSION_TICKETS_DISABLED 0
+#define MBEDTLS_SSL_SESSION_TICKETS_ENABLED 1
+
+typedef enum {
+  MBEDTLS_SSL_HELLO_REQUEST,
+  MBEDTLS_SSL_CLIENT_HELLO,
+  MBEDTLS_SSL_SERVER_HELLO,
+  MBEDTLS_SSL_SERVER_CERTIFICATE,
+  MBEDTLS_SSL_SERVER_KEY_EXCHANGE,
+  MBEDTLS_SSL_CERTIFICATE_REQUEST,
+  MBEDTLS_SSL_SERVER_HELLO_DONE,
+  MBEDTLS_SSL_CLIENT_CERTIFICATE,
+  MBEDTLS_SSL_CLIENT_KEY_EXCHANGE,
+  MBEDTLS_SSL_CERTIFICATE_VERIFY,
+  MBEDTLS_SSL_CLIENT_CHANGE_CIPHER_SPEC,
+  MBEDTLS_SSL_CLIENT_FINISHED,
+  MBEDTLS_SSL_SERVER_CHANGE_CIPHER_SPEC,
+  MBEDTLS_SSL_SERVER_FINISHED,
+  MBEDTLS_SSL_FLUSH_BUFFERS,
+  MBEDTLS_SSL_HANDSHAKE_WRAPUP,
+  MBEDTLS_SSL_HANDSHAKE_OVER,
+} mbedtls_ssl_states;
+
+typedef int mbedtls_ssl_send_t(void *ctx, const unsigned char *buf, size_t len);
+typedef int mbedtls_ssl_recv_t(void *ctx, unsigned char *buf, size_t len);
+typedef int mbedtls_ssl_recv_timeout_t(void *ctx, unsigned char *buf, size_t len, uint32_t timeout);
+
+struct mbedtls_ssl_config {
+  int unused;
+};
+
+struct mbedtls_ssl_session {
+  size_t id_len;
+};
+
+struct mbedtls_ssl_context {
+  int state;
+};
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config *conf);
+void mbedtls_ssl_config_free(mbedtls_ssl_config *conf);
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config *conf, int endpoint, int transport, int preset);
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *conf, int authmode);
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config *conf, int (*f_rng)(void *, unsigned char *, size_t), void *p_rng);
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config *conf, int use_tickets);
+
+void mbedtls_ssl_init(mbedtls_ssl_context *ssl);
+void mbedtls_ssl_free(mbedtls_ssl_context *ssl);
+int mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf);
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context *ssl, const char *hostname);
+void mbedtls_ssl_set_bio(mbedtls_ssl_context *ssl, void *p_bio, mbedtls_ssl_send_t *f_send,
+                         mbedtls_ssl_recv_t *f_recv, mbedtls_ssl_recv_timeout_t *f_recv_timeout);
+int mbedtls_ssl_handshake_step(mbedtls_ssl_context *ssl);
+const char *mbedtls_ssl_get_ciphersuite(const mbedtls_ssl_context *ssl);
+int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len);
+int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len);
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *ssl);
+int mbedtls_ssl_close_notify(mbedtls_ssl_context *ssl);
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session);
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session);
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *ssl, mbedtls_ssl_session *session);
+int mbedtls_ssl_set_session(mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session);
+int mbedtls_ssl_session_save(const mbedtls_ssl_session *session, unsigned char *buf, size_t buf_len, size_t *olen);
+int mbedtls_ssl_session_load(mbedtls_ssl_session *session, const unsigned char *buf, size_t len);
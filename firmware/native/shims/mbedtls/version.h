@@ -0,0 +1,4 @@
+// Host shim, the 2.28 line ESP-IDF 4.4 ships
+#pragma once
+#define MBEDTLS_VERSION_MAJOR 2
+#define MBEDTLS_VERSION_MINOR 28
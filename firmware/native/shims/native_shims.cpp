@@ -0,0 +1,390 @@
+// Host implementations behind the Arduino / FreeRTOS / LittleFS shims.
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <deque>
+#include <mutex>
+#define OPENSSL_SUPPRESS_DEPRECATED  // AES_encrypt is all the shim needs
+#include <openssl/aes.h>
+#include <openssl/rand.h>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "LittleFS.h"
+#include "SPI.h"
+#include "WiFi.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/error.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/ssl.h"
+
+/* ================================ TIME ================================ */
+
+static const auto bootTime = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long millis() { return (unsigned long)(esp_timer_get_time() / 1000); }
+unsigned long micros() { return (unsigned long)esp_timer_get_time(); }
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void yield() { std::this_thread::yield(); }
+
+static std::mt19937 &rng() {
+  static std::mt19937 gen(12345);
+  return gen;
+}
+void randomSeed(unsigned long seed) { rng().seed(seed); }
+long random(long howbig) { return howbig <= 0 ? 0 : (long)(rng()() % (unsigned long)howbig); }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+
+/* ================================ SERIAL ================================ */
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+WiFiClass WiFi;
+
+// Serial input is stdin, so firmware_app takes the same commands as the UART
+static std::atomic<bool> stdinClosed{false};
+int HardwareSerial::available() {
+  if (stdinClosed) return 0;
+  pollfd fd = {STDIN_FILENO, POLLIN, 0};
+  return poll(&fd, 1, 0) > 0 && (fd.revents & (POLLIN | POLLHUP)) ? 1 : 0;
+}
+int HardwareSerial::read() {
+  unsigned char c;
+  if (!available()) return -1;
+  if (::read(STDIN_FILENO, &c, 1) != 1) {
+    stdinClosed = true;  // EOF, e.g. piped input ran out
+    return -1;
+  }
+  return c;
+}
+size_t HardwareSerial::write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+size_t HardwareSerial::write(const uint8_t *buf, size_t size) { return fwrite(buf, 1, size, stdout); }
+
+size_t Print::printf(const char *format, ...) {
+  char buf[512];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  return n > 0 ? write((const uint8_t *)buf, std::min<size_t>(n, sizeof(buf) - 1)) : 0;
+}
+
+/* ================================ FREERTOS ================================ */
+
+struct NativeTask {
+  std::thread thread;
+  std::mutex lock;
+  std::condition_variable cv;
+  uint32_t notifications = 0;
+};
+
+static thread_local NativeTask *currentTask = nullptr;
+static std::recursive_mutex criticalLock;
+
+void vPortEnterCritical(portMUX_TYPE *) { criticalLock.lock(); }
+void vPortExitCritical(portMUX_TYPE *) { criticalLock.unlock(); }
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth,
+                       void *param, UBaseType_t priority, TaskHandle_t *handle) {
+  NativeTask *task = new NativeTask();
+  if (handle) *handle = task;
+  task->thread = std::thread([task, fn, param]() {
+    currentTask = task;
+    fn(param);
+  });
+  task->thread.detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Threads cannot be cancelled safely: a task deleting itself parks, deleting
+  // another task only forgets its handle and the thread keeps running.
+  if (task == nullptr || task == currentTask) {
+    while (true) std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+}
+
+void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return currentTask; }
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+  NativeTask *task = currentTask;
+  if (task == nullptr) {
+    vTaskDelay(ticksToWait == portMAX_DELAY ? 1 : ticksToWait);
+    return 0;
+  }
+  std::unique_lock<std::mutex> guard(task->lock);
+  auto ready = [task]() { return task->notifications > 0; };
+  if (ticksToWait == portMAX_DELAY) {
+    task->cv.wait(guard, ready);
+  } else {
+    task->cv.wait_for(guard, std::chrono::milliseconds(ticksToWait), ready);
+  }
+  uint32_t value = task->notifications;
+  if (value) task->notifications = clearOnExit ? 0 : value - 1;
+  return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (task == nullptr) return pdFAIL;
+  {
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notifications++;
+  }
+  task->cv.notify_one();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken) {
+  xTaskNotifyGive(task);
+  if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdTRUE;
+}
+
+struct NativeQueue {
+  std::mutex lock;
+  std::condition_variable cv;
+  std::deque<std::vector<uint8_t>> items;
+  size_t length;
+  size_t itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  NativeQueue *q = new NativeQueue();
+  q->length = length;
+  q->itemSize = itemSize;
+  return q;
+}
+
+void vQueueDelete(QueueHandle_t q) { delete q; }
+
+static BaseType_t queuePut(QueueHandle_t q, const void *item, bool front) {
+  std::lock_guard<std::mutex> guard(q->lock);
+  if (q->items.size() >= q->length) return pdFAIL;
+  std::vector<uint8_t> copy((const uint8_t *)item, (const uint8_t *)item + q->itemSize);
+  if (front) {
+    q->items.push_front(std::move(copy));
+  } else {
+    q->items.push_back(std::move(copy));
+  }
+  q->cv.notify_one();
+  return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t) { return queuePut(q, item, false); }
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t) { return queuePut(q, item, true); }
+
+static BaseType_t queueGet(QueueHandle_t q, void *item, TickType_t ticksToWait, bool remove) {
+  std::unique_lock<std::mutex> guard(q->lock);
+  auto ready = [q]() { return !q->items.empty(); };
+  if (ticksToWait == portMAX_DELAY) {
+    q->cv.wait(guard, ready);
+  } else if (!q->cv.wait_for(guard, std::chrono::milliseconds(ticksToWait), ready)) {
+    return pdFAIL;
+  }
+  memcpy(item, q->items.front().data(), q->itemSize);
+  if (remove) q->items.pop_front();
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticksToWait) { return queueGet(q, item, ticksToWait, true); }
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t ticksToWait) { return queueGet(q, item, ticksToWait, false); }
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> guard(q->lock);
+  return q->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+  std::lock_guard<std::mutex> guard(q->lock);
+  return q->length - q->items.size();
+}
+
+struct NativeMutex {
+  std::recursive_timed_mutex lock;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeMutex(); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new NativeMutex(); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticksToWait) {
+  if (ticksToWait == portMAX_DELAY) {
+    m->lock.lock();
+    return pdTRUE;
+  }
+  return m->lock.try_lock_for(std::chrono::milliseconds(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m) {
+  m->lock.unlock();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t m, TickType_t ticksToWait) { return xSemaphoreTake(m, ticksToWait); }
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t m) { return xSemaphoreGive(m); }
+void vSemaphoreDelete(SemaphoreHandle_t m) { delete m; }
+
+/* ================================ LITTLEFS ================================ */
+
+LittleFSFS LittleFS;
+
+static std::string fsRoot() {
+  const char *root = getenv("NATIVE_LITTLEFS_ROOT");
+  return root ? root : "littlefs";
+}
+
+static std::string fsPath(const char *path) { return fsRoot() + (path[0] == '/' ? "" : "/") + path; }
+
+bool LittleFSFS::begin(bool) {
+  ::mkdir(fsRoot().c_str(), 0755);
+  return true;
+}
+
+size_t LittleFSFS::usedBytes() { return 0; }
+
+bool LittleFSFS::exists(const char *path) {
+  struct stat st;
+  return stat(fsPath(path).c_str(), &st) == 0;
+}
+
+File LittleFSFS::open(const char *path, const char *mode) {
+  // "w" on LittleFS keeps the file readable and seekable
+  std::string m = mode;
+  if (m == "w") m = "w+";
+  FILE *f = fopen(fsPath(path).c_str(), m.c_str());
+  return f ? File(f) : File();
+}
+
+bool LittleFSFS::remove(const char *path) { return ::remove(fsPath(path).c_str()) == 0; }
+bool LittleFSFS::mkdir(const char *path) { return ::mkdir(fsPath(path).c_str(), 0755) == 0 || exists(path); }
+
+int File::available() {
+  if (!f_) return 0;
+  long pos = ftell(f_.get());
+  return (int)(size() - pos);
+}
+
+int File::read() {
+  if (!f_) return -1;
+  int c = fgetc(f_.get());
+  return c == EOF ? -1 : c;
+}
+
+size_t File::size() const {
+  if (!f_) return 0;
+  long pos = ftell(f_.get());
+  fseek(f_.get(), 0, SEEK_END);
+  long end = ftell(f_.get());
+  fseek(f_.get(), pos, SEEK_SET);
+  return (size_t)end;
+}
+
+// mbedtls AES on OpenSSL, CTR mode written out the way mbedtls does it
+void mbedtls_aes_init(mbedtls_aes_context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+void mbedtls_aes_free(mbedtls_aes_context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits) {
+  static_assert(sizeof(AES_KEY) <= sizeof(ctx->key), "AES_KEY does not fit");
+  if (keybits != 128 && keybits != 192 && keybits != 256) return MBEDTLS_ERR_AES_INVALID_KEY_LENGTH;
+  return AES_set_encrypt_key(key, keybits, reinterpret_cast<AES_KEY *>(ctx->key)) == 0
+             ? 0
+             : MBEDTLS_ERR_AES_INVALID_KEY_LENGTH;
+}
+
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length, size_t *nc_off, unsigned char nonce_counter[16],
+                          unsigned char stream_block[16], const unsigned char *input, unsigned char *output) {
+  size_t n = *nc_off;
+  for (size_t i = 0; i < length; i++) {
+    if (n == 0) {
+      AES_encrypt(nonce_counter, stream_block, reinterpret_cast<const AES_KEY *>(ctx->key));
+      for (int c = 15; c >= 0; c--) {
+        if (++nonce_counter[c] != 0) break;
+      }
+    }
+    output[i] = input[i] ^ stream_block[n];
+    n = (n + 1) & 0x0F;
+  }
+  *nc_off = n;
+  return 0;
+}
+
+// mbedtls TLS client, never gets past ClientHello: no network on the host
+void mbedtls_entropy_init(mbedtls_entropy_context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+void mbedtls_entropy_free(mbedtls_entropy_context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+int mbedtls_entropy_func(void *, unsigned char *output, size_t len) { return RAND_bytes(output, len) == 1 ? 0 : -1; }
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context *, int (*)(void *, unsigned char *, size_t), void *,
+                          const unsigned char *, size_t) {
+  return 0;
+}
+int mbedtls_ctr_drbg_random(void *, unsigned char *output, size_t output_len) {
+  return RAND_bytes(output, output_len) == 1 ? 0 : -1;
+}
+
+void mbedtls_strerror(int errnum, char *buffer, size_t buflen) {
+  snprintf(buffer, buflen, "SSL - shim error -0x%04x", -errnum);
+}
+
+void mbedtls_net_init(mbedtls_net_context *ctx) { ctx->fd = -1; }
+void mbedtls_net_free(mbedtls_net_context *ctx) {
+  if (ctx->fd >= 0) close(ctx->fd);
+  ctx->fd = -1;
+}
+int mbedtls_net_send(void *, const unsigned char *, size_t) { return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE; }
+int mbedtls_net_recv(void *, unsigned char *, size_t) { return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE; }
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config *conf) { memset(conf, 0, sizeof(*conf)); }
+void mbedtls_ssl_config_free(mbedtls_ssl_config *conf) { memset(conf, 0, sizeof(*conf)); }
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config *, int, int, int) { return 0; }
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *, int) {}
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config *, int (*)(void *, unsigned char *, size_t), void *) {}
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config *, int) {}
+
+void mbedtls_ssl_init(mbedtls_ssl_context *ssl) { ssl->state = MBEDTLS_SSL_HELLO_REQUEST; }
+void mbedtls_ssl_free(mbedtls_ssl_context *ssl) { ssl->state = MBEDTLS_SSL_HELLO_REQUEST; }
+int mbedtls_ssl_setup(mbedtls_ssl_context *, const mbedtls_ssl_config *) { return 0; }
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context *, const char *) { return 0; }
+void mbedtls_ssl_set_bio(mbedtls_ssl_context *, void *, mbedtls_ssl_send_t *, mbedtls_ssl_recv_t *,
+                         mbedtls_ssl_recv_timeout_t *) {}
+int mbedtls_ssl_handshake_step(mbedtls_ssl_context *ssl) {
+  ssl->state = MBEDTLS_SSL_CLIENT_HELLO;
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+const char *mbedtls_ssl_get_ciphersuite(const mbedtls_ssl_context *) { return "unknown"; }
+int mbedtls_ssl_read(mbedtls_ssl_context *, unsigned char *, size_t) { return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE; }
+int mbedtls_ssl_write(mbedtls_ssl_context *, const unsigned char *, size_t) {
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *) { return 0; }
+int mbedtls_ssl_close_notify(mbedtls_ssl_context *) { return 0; }
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session) { memset(session, 0, sizeof(*session)); }
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session) { memset(session, 0, sizeof(*session)); }
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *, mbedtls_ssl_session *) { return MBEDTLS_ERR_SSL_BAD_INPUT_DATA; }
+int mbedtls_ssl_set_session(mbedtls_ssl_context *, const mbedtls_ssl_session *) { return 0; }
+int mbedtls_ssl_session_save(const mbedtls_ssl_session *, unsigned char *, size_t, size_t *olen) {
+  *olen = 0;
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+int mbedtls_ssl_session_load(mbedtls_ssl_session *, const unsigned char *, size_t) {
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
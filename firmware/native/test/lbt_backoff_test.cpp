@@ -0,0 +1,107 @@
+// Listen-before-talk on LoRaComT<FakeRadio>: the backoff window doubles with
+// every busy CAD up to LBT_BACKOFF_MAX_MS, the frame goes out anyway after
+// LBT_MAX_ATTEMPTS, and a frame held by the duty-cycle budget costs no CAD.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "LoRaComT.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: FAIL: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+static std::atomic<uint32_t> sent{0};
+
+static void onSent(bool success, uint32_t, void *) {
+  if (success) sent++;
+}
+
+static void sleepMs(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+static uint32_t backoffWindowMs(size_t attempt) {
+  uint32_t window = (uint32_t)LBT_BACKOFF_MIN_MS << attempt;
+  return window > LBT_BACKOFF_MAX_MS ? LBT_BACKOFF_MAX_MS : window;
+}
+
+// One frame on a channel that never clears, returns the backoff of each busy scan
+static std::vector<uint32_t> sendOnBusyChannel(LoRaCom *lora) {
+  std::vector<uint32_t> backoffs;
+  uint32_t sentBefore = sent;
+  uint32_t lastBackoffMs = lora->getLbtStats().backoffMs;
+  lora->setFakeBusyScans(255);
+  uint8_t frame[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  CHECK(lora->send(frame, sizeof(frame), onSent));
+  for (int ms = 0; ms < 5000 && sent == sentBefore; ms++) {
+    uint32_t backoffMs = lora->getLbtStats().backoffMs;
+    if (backoffMs != lastBackoffMs) {
+      backoffs.push_back(backoffMs - lastBackoffMs);
+      lastBackoffMs = backoffMs;
+    }
+    sleepMs(1);
+  }
+  CHECK(sent == sentBefore + 1);
+  lora->setFakeBusyScans(0);
+  return backoffs;
+}
+
+int main() {
+  LoRaComFake *lora = new LoRaComFake();
+  CHECK(lora->begin(LORA_SCK, LORA_MISO, LORA_MOSI, LORA_CS, LORA_DIO1, LORA_RESET, LORA_FREQUENCY, LORA_POWER,
+                    LORA_BUSY));
+  lora->setLbtEnabled(true);
+  lora->startRadioTask();
+
+  // Backoff: LBT_MAX_ATTEMPTS busy scans each within its window, then a forced send
+  const int runs = 5;
+  uint32_t largestLast = 0;
+  for (int run = 0; run < runs; run++) {
+    std::vector<uint32_t> backoffs = sendOnBusyChannel(lora);
+    CHECK(backoffs.size() == LBT_MAX_ATTEMPTS);
+    for (size_t attempt = 0; attempt < backoffs.size(); attempt++) {
+      CHECK(backoffs[attempt] >= LBT_BACKOFF_MIN_MS);
+      CHECK(backoffs[attempt] < LBT_BACKOFF_MIN_MS + backoffWindowMs(attempt));
+    }
+    if (!backoffs.empty() && backoffs.back() > largestLast) largestLast = backoffs.back();
+  }
+  // The last window is far wider than the first one
+  CHECK(largestLast >= LBT_BACKOFF_MIN_MS + backoffWindowMs(0));
+  LbtStats lbt = lora->getLbtStats();
+  CHECK(lbt.deferred == runs);
+  CHECK(lbt.forced == runs);
+  CHECK(lbt.busy == runs * (LBT_MAX_ATTEMPTS + 1));
+
+#if TX_DUTY_CYCLE_LIMIT_ENABLED
+  // Budget: long frames until one is held back, then no CAD may be spent on it
+  lora->setSpreadingFactor(12);
+  uint8_t frame[LORA_MAX_PACKET_LEN];
+  memset(frame, 0x55, sizeof(frame));
+  for (int i = 0; i < 100 && lora->getAirtimeStats().deferred == 0; i++) {
+    CHECK(lora->send(frame, sizeof(frame), onSent));
+    sleepMs(20);
+  }
+  CHECK(lora->getAirtimeStats().deferred == 1);
+  CHECK(lora->getTxQueued() == 1);
+  uint32_t busyBefore = lora->getLbtStats().busy;
+  lora->setFakeBusyScans(1);
+  CHECK(lora->send(frame, 1, onSent));  // Wakes the radio task again
+  sleepMs(200);
+  CHECK(lora->getLbtStats().busy == busyBefore);
+  CHECK(lora->getTxQueued() == 2);
+#endif
+
+  printf("lbt_backoff_test: %s\n", failures ? "FAILED" : "passed");
+  fflush(stdout);
+  // The radio task never returns, leave without running static destructors under it
+  std::_Exit(failures ? 1 : 0);
+}
@@ -0,0 +1,78 @@
+// MeshHeaderView against the shift code it replaced in Control::loRaDataTask
+// and against the flag bit layout, over random headers and the edge cases.
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "MeshHeader.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: FAIL: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+// The old decoding of to and from, byte by byte
+static uint32_t shiftLe32(const uint8_t *header, size_t offset) {
+  return ((uint32_t)header[offset + 3] << 24) | ((uint32_t)header[offset + 2] << 16) |
+         ((uint32_t)header[offset + 1] << 8) | header[offset];
+}
+
+static void checkHeader(const uint8_t *data) {
+  MeshHeaderView view(data, MESH_HEADER_LEN);
+  CHECK(view.valid());
+  CHECK(view.to() == shiftLe32(data, 0));
+  CHECK(view.from() == shiftLe32(data, 4));
+  CHECK(view.id() == shiftLe32(data, 8));
+  CHECK(view.flags() == data[12]);
+  CHECK(view.channelHash() == data[13]);
+  CHECK(view.nextHop() == data[14]);
+  CHECK(view.relayNode() == data[15]);
+
+  uint8_t flags = data[12];
+  uint8_t hopLimit = flags & 0x07;
+  uint8_t hopStart = flags >> 5;
+  CHECK(view.hopLimit() == hopLimit);
+  CHECK(view.wantAck() == ((flags >> 3) & 1));
+  CHECK(view.viaMqtt() == ((flags >> 4) & 1));
+  CHECK(view.hopStart() == hopStart);
+  CHECK(view.hopsAway() == (hopStart >= hopLimit ? hopStart - hopLimit : 0));
+  CHECK(view.isBroadcast() == (shiftLe32(data, 0) == 0xFFFFFFFF));
+  CHECK(view.payload() == data + MESH_HEADER_LEN);
+}
+
+int main() {
+  uint8_t packet[MESH_HEADER_LEN + 8] = {};
+
+  // Every flag byte, the rest of the header fixed
+  for (int flags = 0; flags < 256; flags++) {
+    packet[12] = (uint8_t)flags;
+    checkHeader(packet);
+  }
+
+  // Random headers, high bits set in every byte on a share of them
+  std::mt19937 rng(7);
+  for (int i = 0; i < 100000; i++) {
+    for (size_t b = 0; b < MESH_HEADER_LEN; b++) packet[b] = (uint8_t)rng();
+    checkHeader(packet);
+  }
+
+  // Broadcast and all-ones headers
+  for (size_t b = 0; b < MESH_HEADER_LEN; b++) packet[b] = 0xFF;
+  checkHeader(packet);
+  CHECK(MeshHeaderView(packet, MESH_HEADER_LEN).isBroadcast());
+  CHECK(MeshHeaderView(packet, MESH_HEADER_LEN).hopsAway() == 0);
+
+  // Too short for a header, whatever the bytes are
+  for (size_t length = 0; length < MESH_HEADER_LEN; length++) {
+    CHECK(!MeshHeaderView(packet, length).valid());
+  }
+  CHECK(MeshHeaderView(packet, sizeof(packet)).valid());
+
+  printf("mesh_header_test: %s\n", failures ? "FAILED" : "passed");
+  return failures ? 1 : 0;
+}
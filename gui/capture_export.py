@@ -0,0 +1,190 @@
+"""Bulk export of the on-flash packet capture ("flash export") into a replay trace.
+
+The firmware answers "flash export <offset>" with
+
+    capture_begin from=<offset> size=<log bytes> page=<page size> segment_bytes=<segment size>
+    capture_chunk n=<index> off=<offset> len=<bytes> crc=<crc32 hex> <base64>     (one per page holding records)
+    capture_end chunks=<n> bytes=<n> ms=<n>
+
+A chunk that fails its CRC (a log line printed into the middle of it) is
+fetched again by resuming the export at its offset. A chunk whose header is
+unreadable or that never arrived shows up as a gap in the chunk index: the
+export resumes right after the last good chunk before the gap. The records
+are written as a trace for "command mode replay start <file> <speed>":
+
+    <delta_ms> <rssi_dbm> <snr_db> <packet bytes as hex>
+"""
+import base64
+import struct
+import sys
+import zlib
+
+SEGMENT_MAGIC = 0x5350414C
+RECORD_MAGIC = 0xCA57
+CAPTURE_VERSION = 1
+FLAG_CRC_OK = 0x01
+SEGMENT_HEADER = struct.Struct("<IHHII")  # magic, version, pageSize, generation, firstSeq
+RECORD_HEADER = struct.Struct("<HHIqhbBBBHiI")  # magic, length, seq, timestampUs, rssiDeci, snrQuarter, flags, sf, cr, bwDeci, freqErrorHz, crc
+
+
+def _fields(line):
+    return dict(item.split("=", 1) for item in line.split() if "=" in item)
+
+
+class CaptureExport:
+    def __init__(self):
+        self.chunks = {}  # offset -> valid bytes of that page
+        self.size = 0
+        self.page_size = 0
+        self.segment_bytes = 0
+        self.bad_offset = None  # Lowest offset to fetch again
+        self.start = 0  # Offset this pass started from
+        self.next_index = 0  # Chunk index expected next in this pass
+        self.last_offset = None  # Offset of the last chunk with a readable header in this pass
+        self.done = False
+        self.summary = ""
+
+    def _mark_bad(self, offset):
+        if self.bad_offset is None or offset < self.bad_offset:
+            self.bad_offset = offset
+
+    def _after_last_chunk(self):
+        """Where a chunk lost after the last readable one can start."""
+        return self.start if self.last_offset is None else self.last_offset + self.page_size
+
+    def feed(self, line):
+        """Takes one serial line, returns False when it is not part of the export."""
+        # A log line printed without its newline may sit in front of an export line
+        for tag in ("capture_begin ", "capture_chunk ", "capture_end"):
+            pos = line.find(tag)
+            if pos >= 0:
+                line = line[pos:]
+                break
+        else:
+            return False
+
+        if tag == "capture_begin ":
+            fields = _fields(line)
+            self.size = int(fields["size"])
+            self.page_size = int(fields["page"])
+            self.segment_bytes = int(fields["segment_bytes"])
+            # Chunks from the resume offset on are sent again
+            self.start = int(fields["from"])
+            self.chunks = {off: data for off, data in self.chunks.items() if off < self.start}
+            self.next_index = 0
+            self.last_offset = None
+            self.done = False
+        elif tag == "capture_chunk ":
+            parts = line.split()
+            try:
+                fields = _fields(" ".join(parts[1:5]))
+                index = int(fields["n"])
+                offset = int(fields["off"])
+                length = int(fields["len"])
+                crc = int(fields["crc"], 16)
+            except (KeyError, ValueError):
+                return True  # Header unreadable, the index gap at the next chunk or at the end catches it
+            if index != self.next_index:
+                self._mark_bad(self._after_last_chunk())  # Chunks in between were lost
+            self.next_index = index + 1
+            self.last_offset = offset
+            try:
+                data = base64.b64decode(parts[5], validate=True) if len(parts) == 6 else b""
+            except ValueError:
+                data = b""
+            if len(data) == length and zlib.crc32(data) == crc:
+                self.chunks[offset] = data
+            else:
+                self._mark_bad(offset)
+        else:
+            fields = _fields(line)
+            if "chunks" in fields and int(fields["chunks"]) != self.next_index:
+                self._mark_bad(self._after_last_chunk())  # The last chunks were lost
+            self.done = True
+            self.summary = line
+        return True
+
+    def resume_offset(self):
+        """Offset to export again from once done, None when everything arrived."""
+        offset, self.bad_offset = self.bad_offset, None
+        return offset
+
+    def records(self):
+        """Records that pass their CRC, oldest first."""
+        records = []
+        for segment_offset in range(0, self.size, self.segment_bytes or 1):
+            head = self.chunks.get(segment_offset, b"")
+            if len(head) < SEGMENT_HEADER.size:
+                continue
+            magic, version, page_size, generation, _ = SEGMENT_HEADER.unpack_from(head)
+            if magic != SEGMENT_MAGIC or version != CAPTURE_VERSION or page_size != self.page_size:
+                continue
+            for page_offset in range(segment_offset, segment_offset + self.segment_bytes, self.page_size):
+                page = self.chunks.get(page_offset, b"")
+                pos = SEGMENT_HEADER.size if page_offset == segment_offset else 0
+                while pos + RECORD_HEADER.size <= len(page):
+                    header = RECORD_HEADER.unpack_from(page, pos)
+                    length = header[1]
+                    end = pos + RECORD_HEADER.size + length
+                    if header[0] != RECORD_MAGIC or end > len(page):
+                        break
+                    # CRC over the generation, the header with crc = 0 and the data
+                    crc = zlib.crc32(struct.pack("<I", generation))
+                    crc = zlib.crc32(page[pos:pos + RECORD_HEADER.size - 4] + bytes(4), crc)
+                    crc = zlib.crc32(page[pos + RECORD_HEADER.size:end], crc)
+                    if crc != header[11]:
+                        break
+                    records.append((generation, header, page[pos + RECORD_HEADER.size:end]))
+                    pos = end
+        records.sort(key=lambda r: (r[0], r[1][2]))
+        return records
+
+    def write_trace(self, path):
+        """Writes the replay trace, returns (written, skipped with a bad CRC on air)."""
+        written = skipped = 0
+        last_us = None
+        with open(path, "w") as out:
+            records = self.records()
+            out.write(f"# flash capture export: {len(records)} records\n")
+            for _, header, data in records:
+                timestamp_us, rssi_deci, snr_quarter, flags = header[3], header[4], header[5], header[6]
+                if not flags & FLAG_CRC_OK:
+                    skipped += 1  # The replay has no way to mark a CRC error
+                    continue
+                # esp_timer restarts at boot, a backwards step starts the next run
+                delta_ms = 0 if last_us is None or timestamp_us < last_us else (timestamp_us - last_us) // 1000
+                last_us = timestamp_us
+                out.write(f"{delta_ms} {rssi_deci / 10:.1f} {snr_quarter / 4:.2f} {data.hex()}\n")
+                written += 1
+        return written, skipped
+
+
+def main():
+    import serial
+
+    if len(sys.argv) != 3:
+        print("usage: capture_export.py <serial port> <trace file>")
+        return 1
+    export = CaptureExport()
+    with serial.Serial(sys.argv[1], 115200, timeout=5) as port:
+        offset = 0
+        for _ in range(5):
+            export.done = False
+            port.write(f"flash export {offset}\n".encode())
+            while not export.done:
+                line = port.readline()
+                if not line:
+                    print("timeout waiting for the export")
+                    return 1
+                export.feed(line.decode("ascii", errors="ignore").strip())
+            offset = export.resume_offset()
+            if offset is None:
+                break
+            print(f"bad chunk, resuming at {offset}")
+    written, skipped = export.write_trace(sys.argv[2])
+    print(f"{export.summary}: {written} records written, {skipped} with CRC errors skipped")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,5 +1,5 @@
 import tkinter as tk
-from tkinter import ttk, messagebox, scrolledtext
+from tkinter import ttk, messagebox, scrolledtext, filedialog
 import serial
 import serial.tools.list_ports
 import threading
@@ -8,6 +8,8 @@ import json
 import os
 import re
 
+from capture_export import CaptureExport
+
 class LoRaTransceiverGUI:
     def __init__(self, root):
         self.root = root
@@ -29,6 +31,11 @@ class LoRaTransceiverGUI:
         self.read_thread = None
         self.stop_reading = False
 
+        # Flash capture export in progress, fed from the serial thread
+        self.capture_export = None
+        self.capture_export_path = None
+        self.capture_export_retries = 0
+
     def create_widgets(self):
         # Connection frame
         conn_frame = ttk.LabelFrame(self.root, text="Connection", padding="10")
@@ -79,6 +86,32 @@ class LoRaTransceiverGUI:
         self.debug_text = scrolledtext.ScrolledText(debug_frame, height=20)
         self.debug_text.pack(fill="both", expand=True, padx=10, pady=10)
 
+        # Nodes tab: live node table from "get nodes"
+        nodes_frame = ttk.Frame(self.notebook)
+        self.notebook.add(nodes_frame, text="Nodes")
+
+        nodes_controls_frame = ttk.Frame(nodes_frame)
+        nodes_controls_frame.pack(fill="x", padx=10, pady=5)
+
+        self.refresh_nodes_btn = ttk.Button(nodes_controls_frame, text="Refresh", command=lambda: self.send_command("get nodes"))
+        self.refresh_nodes_btn.pack(side="left", padx=5)
+
+        self.nodes_auto_var = tk.BooleanVar(value=False)
+        self.nodes_auto_check = ttk.Checkbutton(nodes_controls_frame, text="Auto refresh (5 s)", variable=self.nodes_auto_var, command=self.poll_nodes)
+        self.nodes_auto_check.pack(side="left", padx=5)
+
+        self.nodes_summary_label = ttk.Label(nodes_controls_frame, text="Nodes: -")
+        self.nodes_summary_label.pack(side="right", padx=5)
+
+        node_columns = ("id", "packets", "first", "last", "rssi", "snr", "hops", "hist")
+        node_headings = ("Node ID", "Packets", "First seen, s", "Last seen, s", "RSSI avg", "SNR avg", "Hops min/avg/max", "RSSI hist <-120..>=-70")
+        self.nodes_tree = ttk.Treeview(nodes_frame, columns=node_columns, show="headings")
+        for column, heading in zip(node_columns, node_headings):
+            self.nodes_tree.heading(column, text=heading)
+            self.nodes_tree.column(column, width=80, anchor="center")
+        self.nodes_tree.column("hist", width=160)
+        self.nodes_tree.pack(fill="both", expand=True, padx=10, pady=10)
+
         # Main layout: left controls, right log
         left_frame = ttk.Frame(config_frame)
         left_frame.pack(side="left", fill="y", padx=10, pady=5)
@@ -325,6 +358,10 @@ class LoRaTransceiverGUI:
             if self.serial_port and self.serial_port.in_waiting:
                 data = self.serial_port.readline().decode('utf-8', errors='ignore').strip()
                 if data:
+                    if self.capture_export and self.capture_export.feed(data):
+                        if self.capture_export.done:
+                            self.finish_capture_export()
+                        continue  # Export lines are not logged, and are read back to back
                     if data.startswith("wifi_status "):
                         status = data.split(" ")[1].strip()
                         if status == "1":
@@ -374,6 +411,8 @@ class LoRaTransceiverGUI:
                     elif data.startswith("post_en "):
                         post_en_val = data.split()[1]
                         self.log(f"Synced post_en define: {post_en_val}")
+                    elif data.startswith("nodes "):
+                        self.root.after(0, self.update_nodes, data)
                     elif data.startswith("ssid "):
                         ssid_val = data.split(" ", 1)[1]
                         self.wifi_current_ssid_label.config(text=f"Current SSID: {ssid_val}")
@@ -388,7 +427,30 @@ class LoRaTransceiverGUI:
                         # Also log to debug tab if network related
                         if any(keyword in data for keyword in ["settings", "defines", "WiFi", "HTTP", "SPIFFS", "Control"]):
                             self.debug_log(data)
-            time.sleep(0.1)
+            else:
+                time.sleep(0.1)  # Only when idle, bursts are read line after line
+
+    def update_nodes(self, frame):
+        # nodes <count> <evicted>;<id>,<pkts>,<first_age_s>,<last_age_s>,<rssi>,<snr>,<hops>,<hist>;...
+        records = frame.split(";")
+        header = records[0].split()
+        self.nodes_tree.delete(*self.nodes_tree.get_children())
+        for record in records[1:]:
+            fields = record.split(",")
+            if len(fields) == 8:
+                self.nodes_tree.insert("", "end", values=fields)
+        if len(header) >= 3:
+            self.nodes_summary_label.config(text=f"Nodes: {header[1]}, evicted: {header[2]}")
+
+    def poll_nodes(self):
+        # Toggling the checkbox restarts the timer instead of starting a second one
+        if getattr(self, "nodes_poll_id", None):
+            self.root.after_cancel(self.nodes_poll_id)
+            self.nodes_poll_id = None
+        if self.nodes_auto_var.get():
+            if self.is_connected:
+                self.send_command("get nodes")
+            self.nodes_poll_id = self.root.after(5000, self.poll_nodes)
 
     def send_command(self, command):
         if not self.is_connected:
@@ -429,8 +491,36 @@ class LoRaTransceiverGUI:
         self.send_command(command)
 
     def read_flash_logs(self):
-        command = "flash"
-        self.send_command(command)
+        # Bulk export of the binary capture, saved as a replay trace
+        if not self.is_connected:
+            messagebox.showerror("Error", "Not connected.")
+            return
+        path = filedialog.asksaveasfilename(title="Save capture as replay trace", defaultextension=".txt",
+                                            initialfile="capture_trace.txt", filetypes=[("Trace", "*.txt")])
+        if not path:
+            return
+        self.capture_export = CaptureExport()
+        self.capture_export_path = path
+        self.capture_export_retries = 0
+        self.send_command("flash export 0")
+
+    def finish_capture_export(self):
+        export = self.capture_export
+        offset = export.resume_offset()
+        if offset is not None and self.capture_export_retries < 5:
+            self.capture_export_retries += 1
+            self.debug_log(f"Capture chunk at {offset} corrupted, resuming export there")
+            self.send_command(f"flash export {offset}")
+            return
+        self.capture_export = None
+        try:
+            written, skipped = export.write_trace(self.capture_export_path)
+        except OSError as e:
+            self.root.after(0, messagebox.showerror, "Error", str(e))
+            return
+        lost = " (some chunks still corrupted)" if offset is not None else ""
+        self.debug_log(f"{export.summary}: {written} records saved to {self.capture_export_path}, "
+                       f"{skipped} with CRC errors skipped{lost}")
 
     def show_help(self):
         help_text = """Available commands:
@@ -444,7 +534,8 @@ class LoRaTransceiverGUI:
 - command set wifi_en <0|1>: Enable/disable wifi connectivity
 - command set post_mode <time|lora>: Set POST mode (periodic or on LoRa receive)
 - data <payload>: Send data
-- flash: Read flash logs
+- flash: Packet capture status
+- flash export <offset>: Bulk export of the packet capture (Read Flash Logs saves it as a replay trace)
 - help: Show general help"""
         messagebox.showinfo("Help", help_text)
 
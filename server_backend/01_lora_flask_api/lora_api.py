@@ -100,8 +100,9 @@ def add_data():
                     (user_id, user_location, cold, hot, alarm_time,
                      destination_nodeid, sender_nodeid, packet_id, header_flags,
                      channel_hash, next_hop, relay_node, packet_data,
-                     signal_level_dbm, full_packet_len, additional_field3, additional_field4)
-                    VALUES (%s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s)
+                     signal_level_dbm, full_packet_len, additional_field3, additional_field4,
+                     noise_floor_dbm, channel_busy, rx_uptime_ms)
+                    VALUES (%s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s)
                 """
 
                 parameters = (
@@ -121,7 +122,10 @@ def add_data():
                     item_copy.get('signal_level_dbm'),
                     item_copy.get('full_packet_len'),
                     item_copy.get('additional_field3'),
-                    item_copy.get('additional_field4')
+                    item_copy.get('additional_field4'),
+                    item_copy.get('noise_floor_dbm'),
+                    item_copy.get('channel_busy'),
+                    item_copy.get('rx_uptime_ms')
                 )
 
                 try:
@@ -154,8 +158,9 @@ def add_data():
                 (user_id, user_location, cold, hot, alarm_time,
                  destination_nodeid, sender_nodeid, packet_id, header_flags,
                  channel_hash, next_hop, relay_node, packet_data,
-                 signal_level_dbm, full_packet_len, additional_field3, additional_field4)
-                VALUES (%s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s)
+                 signal_level_dbm, full_packet_len, additional_field3, additional_field4,
+                 noise_floor_dbm, channel_busy, rx_uptime_ms)
+                VALUES (%s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s)
                 RETURNING line_num, created_at
             """
 
@@ -176,7 +181,10 @@ def add_data():
                 data_copy.get('signal_level_dbm'),
                 data_copy.get('full_packet_len'),
                 data_copy.get('additional_field3'),
-                data_copy.get('additional_field4')
+                data_copy.get('additional_field4'),
+                data_copy.get('noise_floor_dbm'),
+                data_copy.get('channel_busy'),
+                data_copy.get('rx_uptime_ms')
             )
 
             cur.execute(query, parameters)